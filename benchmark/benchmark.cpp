@@ -0,0 +1,83 @@
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <map>
+#include <fstream>
+#include <unistd.h>
+
+#include "benchmark.hpp"
+
+using namespace std;
+
+// function-local static avoids depending on the initialization order of the translation units
+map<string, BenchmarkEntry> &benchmarkRegistry()
+{
+    static map<string, BenchmarkEntry> registry;
+    return registry;
+}
+
+BenchmarkRegistration::BenchmarkRegistration(const std::string &name, const std::string &description, BenchmarkFunction function)
+{
+    BenchmarkEntry entry;
+    entry.description = description;
+    entry.function = function;
+    benchmarkRegistry()[name] = entry;
+}
+
+string kittiImageFile(const BenchmarkContext &context, int index)
+{
+    ostringstream imgNumber;
+    imgNumber << setfill('0') << setw(4) << index;
+    return context.dataPath + "images/KITTI/2011_09_26/image_02/data/000000" + imgNumber.str() + ".png";
+}
+
+string kittiLidarFile(const BenchmarkContext &context, int index)
+{
+    ostringstream imgNumber;
+    imgNumber << setfill('0') << setw(4) << index;
+    return context.dataPath + "images/KITTI/2011_09_26/velodyne_points/data/000000" + imgNumber.str() + ".bin";
+}
+
+string yoloFile(const BenchmarkContext &context, const std::string &name)
+{
+    return context.dataPath + "dat/yolo/" + name;
+}
+
+vector<BoundingBox> syntheticBoxes(int nBoxes, cv::Size imgSize, unsigned int seed)
+{
+    vector<BoundingBox> boxes;
+    cv::RNG rng(seed);
+    for (int i = 0; i < nBoxes; ++i)
+    {
+        BoundingBox box;
+        box.boxID = i;
+        box.trackID = -1;
+        box.classID = 2;
+        box.confidence = 0.9;
+        if (i == 0)
+        {
+            box.roi = cv::Rect(420, 170, 380, 140); // vehicle ahead in the ego lane of the KITTI sequence
+        }
+        else
+        {
+            int width = rng.uniform(20, imgSize.width / 4);
+            int height = rng.uniform(20, imgSize.height / 2);
+            box.roi = cv::Rect(rng.uniform(0, imgSize.width - width), rng.uniform(0, imgSize.height - height), width, height);
+        }
+        boxes.push_back(box);
+    }
+    return boxes;
+}
+
+double residentMemoryMB()
+{
+    ifstream statm("/proc/self/statm");
+    long pages, residentPages;
+    if (!(statm >> pages >> residentPages))
+    {
+        return -1.0;
+    }
+    return residentPages * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
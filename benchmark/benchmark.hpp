@@ -0,0 +1,56 @@
+
+#ifndef benchmark_hpp
+#define benchmark_hpp
+
+#include <string>
+#include <vector>
+#include <map>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+// settings shared by all benchmarks
+struct BenchmarkContext
+{
+    std::string dataPath; // project root containing the "images" and "dat" folders
+};
+
+typedef void (*BenchmarkFunction)(const BenchmarkContext &context);
+
+// registers a benchmark under the given name so that it can be selected from the command line
+struct BenchmarkRegistration
+{
+    BenchmarkRegistration(const std::string &name, const std::string &description, BenchmarkFunction function);
+};
+
+struct BenchmarkEntry
+{
+    std::string description;
+    BenchmarkFunction function;
+};
+
+// all registered benchmarks by name
+std::map<std::string, BenchmarkEntry> &benchmarkRegistry();
+
+#define REGISTER_BENCHMARK(name, description, function) \
+    static BenchmarkRegistration function##Registration(name, description, function)
+
+// file names of the KITTI sequence shipped with the project
+std::string kittiImageFile(const BenchmarkContext &context, int index);
+std::string kittiLidarFile(const BenchmarkContext &context, int index);
+std::string yoloFile(const BenchmarkContext &context, const std::string &name);
+// bounding boxes with random position and size; box 0 always encloses the vehicle ahead in the KITTI sequence
+std::vector<BoundingBox> syntheticBoxes(int nBoxes, cv::Size imgSize = cv::Size(1242, 375), unsigned int seed = 42);
+
+const int kittiSequenceLength = 78; // no. of camera images and Lidar scans in the KITTI sequence
+
+// resident set size of the benchmark process in MB (-1 if not available on this platform)
+double residentMemoryMB();
+
+// elapsed time in ms since a value returned by cv::getTickCount()
+inline double elapsedMs(double startTicks)
+{
+    return 1000.0 * ((double)cv::getTickCount() - startTicks) / cv::getTickFrequency();
+}
+
+#endif /* benchmark_hpp */
@@ -0,0 +1,54 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include "benchmark.hpp"
+
+using namespace std;
+
+static void printUsage(const char *program)
+{
+    cout << "Usage: " << program << " <benchmark|all> [dataPath]" << endl;
+    cout << "dataPath defaults to \"../\" (the project root when running from the build folder)" << endl << endl;
+    cout << "Available benchmarks:" << endl;
+    for (auto it = benchmarkRegistry().begin(); it != benchmarkRegistry().end(); ++it)
+    {
+        cout << "  " << setw(24) << left << it->first << it->second.description << endl;
+    }
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    BenchmarkContext context;
+    context.dataPath = argc > 2 ? argv[2] : "../";
+    if (!context.dataPath.empty() && context.dataPath[context.dataPath.size() - 1] != '/')
+    {
+        context.dataPath += "/";
+    }
+
+    string selected = argv[1];
+    bool bFound = false;
+    for (auto it = benchmarkRegistry().begin(); it != benchmarkRegistry().end(); ++it)
+    {
+        if (selected == "all" || selected == it->first)
+        {
+            cout << "===== " << it->first << " : " << it->second.description << " =====" << endl;
+            it->second.function(context);
+            cout << endl;
+            bFound = true;
+        }
+    }
+
+    if (!bFound)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "benchmark.hpp"
+#include "camFusion.hpp"
+
+using namespace std;
+
+// matchBoundingBoxes as it was before the vote matrix (prevBoxes x currBoxes x matches), kept as reference;
+// boxes without any match are skipped here as max_element would return the end of an empty map
+static void matchBoundingBoxesReference(vector<cv::DMatch> &matches, map<int, int> &bbBestMatches, DataFrame &prevFrame, DataFrame &currFrame)
+{
+    for (auto &prevBox : prevFrame.boundingBoxes)
+    {
+        map<int, int> matched_pairs;
+        for (auto &currBox : currFrame.boundingBoxes)
+        {
+            for (auto &match : matches)
+            {
+                auto &prev_kpt = prevFrame.keypoints[match.queryIdx].pt;
+                auto prevBox_roi = prevBox.roi;
+                if (prevBox_roi.contains(prev_kpt))
+                {
+                    auto &curr_kpt = currFrame.keypoints[match.trainIdx].pt;
+                    auto currBox_roi = currBox.roi;
+                    if (currBox_roi.contains(curr_kpt))
+                    {
+                        matched_pairs[currBox.boxID]++;
+                    }
+                }
+            }
+        }
+        if (matched_pairs.empty())
+        {
+            continue;
+        }
+        auto bestMatch = std::max_element(matched_pairs.begin(), matched_pairs.end(), [](const std::pair<int, int> &a1, const std::pair<int, int> &a2) { return a1.second < a2.second; });
+        bbBestMatches[prevBox.boxID] = bestMatch->first;
+    }
+}
+
+// no. of current boxes which are the partner of more than one previous box
+static int countDoubleMatches(const map<int, int> &bbMatches)
+{
+    map<int, int> partners;
+    int nDouble = 0;
+    for (auto it = bbMatches.begin(); it != bbMatches.end(); ++it)
+    {
+        nDouble += (++partners[it->second] == 2);
+    }
+    return nDouble;
+}
+
+// bounding box matching with 2k keypoint matches between two frames of 10, 50 and 100 boxes
+static void benchmarkBoxMatching(const BenchmarkContext &context)
+{
+    cv::Size imgSize(1242, 375);
+    int nMatches = 2000, nRepetitions = 20;
+
+    // keypoints spread over the image, moving slightly between the frames
+    cv::RNG rng(7);
+    DataFrame prevFrame, currFrame;
+    vector<cv::DMatch> matches;
+    for (int i = 0; i < nMatches; ++i)
+    {
+        cv::Point2f pt(rng.uniform(0.0f, (float)imgSize.width), rng.uniform(0.0f, (float)imgSize.height));
+        cv::Point2f shift(rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f));
+        prevFrame.keypoints.push_back(cv::KeyPoint(pt, 7.0f));
+        currFrame.keypoints.push_back(cv::KeyPoint(pt + shift, 7.0f));
+        matches.push_back(cv::DMatch(i, i, 0.0f));
+    }
+
+    cout << nMatches << " keypoint matches, times per frame pair" << endl;
+    cout << "boxes | reference   | vote matrix | one-to-one  | identical | double matches (ref. / one-to-one)" << endl;
+    int boxCounts[] = {10, 50, 100};
+    for (int nBoxes : boxCounts)
+    {
+        // the current frame sees the same objects slightly shifted
+        prevFrame.boundingBoxes = syntheticBoxes(nBoxes, imgSize);
+        currFrame.boundingBoxes = prevFrame.boundingBoxes;
+        for (auto it = currFrame.boundingBoxes.begin(); it != currFrame.boundingBoxes.end(); ++it)
+        {
+            it->roi.x += 3;
+        }
+
+        map<int, int> refMatches, voteMatches, oneToOneMatches;
+        double t = (double)cv::getTickCount();
+        for (int rep = 0; rep < nRepetitions; ++rep)
+        {
+            refMatches.clear();
+            matchBoundingBoxesReference(matches, refMatches, prevFrame, currFrame);
+        }
+        double msRef = elapsedMs(t) / nRepetitions;
+
+        // index construction is part of the timing, as it is done once per frame
+        t = (double)cv::getTickCount();
+        for (int rep = 0; rep < nRepetitions; ++rep)
+        {
+            voteMatches.clear();
+            prevFrame.roiIndex.build(prevFrame.boundingBoxes);
+            currFrame.roiIndex.build(currFrame.boundingBoxes);
+            matchBoundingBoxes(matches, voteMatches, prevFrame, currFrame);
+        }
+        double msVote = elapsedMs(t) / nRepetitions;
+
+        t = (double)cv::getTickCount();
+        for (int rep = 0; rep < nRepetitions; ++rep)
+        {
+            oneToOneMatches.clear();
+            prevFrame.roiIndex.build(prevFrame.boundingBoxes);
+            currFrame.roiIndex.build(currFrame.boundingBoxes);
+            matchBoundingBoxes(matches, oneToOneMatches, prevFrame, currFrame, BoxMatchMode::OneToOne);
+        }
+        double msOneToOne = elapsedMs(t) / nRepetitions;
+
+        cout << setw(5) << nBoxes << " | " << fixed << setprecision(3) << setw(8) << msRef << " ms | " << setw(8) << msVote << " ms | "
+             << setw(8) << msOneToOne << " ms | " << setw(9) << (refMatches == voteMatches ? "yes" : "NO") << " | "
+             << countDoubleMatches(refMatches) << " / " << countDoubleMatches(oneToOneMatches) << endl;
+    }
+}
+REGISTER_BENCHMARK("box-matching", "bounding box matching: reference vs. vote matrix vs. one-to-one assignment", benchmarkBoxMatching);
@@ -0,0 +1,113 @@
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "benchmark.hpp"
+#include "camFusion.hpp"
+#include "matching2D.hpp"
+
+using namespace std;
+
+struct CameraTTCSample // keypoints and the matches within the box of the vehicle ahead for one pair of frames
+{
+    vector<cv::KeyPoint> kptsPrev, kptsCurr;
+    vector<cv::DMatch> boxMatches;
+};
+
+// speed and accuracy of the camera TTC estimator modes over the KITTI sequence, the exact median is the reference
+static void benchmarkCameraTTC(const BenchmarkContext &context)
+{
+    double frameRate = 10.0;
+    BoundingBox egoBox = syntheticBoxes(1)[0];
+
+    // Shi-Tomasi keypoints with BRISK descriptors and KNN matching as in the tracking application
+    cout << "detecting and matching keypoints ..." << endl;
+    vector<CameraTTCSample> samples;
+    vector<cv::KeyPoint> kptsPrev;
+    cv::Mat descPrev;
+    cout.setstate(ios_base::failbit); // silence the printouts of the detector and matcher
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        vector<cv::KeyPoint> kptsCurr;
+        cv::Mat descCurr;
+        detKeypointsShiTomasi(kptsCurr, imgGray, false);
+        descKeypoints(kptsCurr, imgGray, descCurr, "BRISK");
+
+        if (i > 0)
+        {
+            CameraTTCSample sample;
+            vector<cv::DMatch> matches;
+            matchDescriptors(kptsPrev, kptsCurr, descPrev, descCurr, matches, "BRISK", "MAT_BF", "SEL_KNN");
+            BoundingBox box = egoBox;
+            clusterKptMatchesWithROI(box, kptsPrev, kptsCurr, matches);
+            sample.kptsPrev = kptsPrev;
+            sample.kptsCurr = kptsCurr;
+            sample.boxMatches = box.kptMatches;
+            samples.push_back(sample);
+        }
+        kptsPrev.swap(kptsCurr);
+        descPrev = descCurr;
+    }
+    cout.clear();
+
+    size_t nMatches = 0, maxMatches = 0;
+    for (auto it = samples.begin(); it != samples.end(); ++it)
+    {
+        nMatches += it->boxMatches.size();
+        maxMatches = max(maxMatches, it->boxMatches.size());
+    }
+    cout << samples.size() << " frame pairs, " << nMatches / max((size_t)1, samples.size()) << " matches in the box on average, "
+         << maxMatches << " at most" << endl;
+
+    struct Mode { string name; CameraTTCOptions options; size_t ratiosStored; };
+    vector<Mode> modes = {
+        {"exact (nth_element)", CameraTTCOptions(CameraTTCMode::Exact), maxMatches * maxMatches},
+        {"sampled, 1000 pairs", CameraTTCOptions(CameraTTCMode::Sampled, 1000), 1000},
+        {"sampled, 4000 pairs", CameraTTCOptions(CameraTTCMode::Sampled, 4000), 4000},
+        {"streaming (P-square)", CameraTTCOptions(CameraTTCMode::Streaming), 5}};
+
+    vector<double> ttcExact;
+    cout << "mode                 |   ms/call | max. ratios stored | mean |dTTC| | max. |dTTC| / TTC" << endl;
+    for (auto &mode : modes)
+    {
+        vector<double> ttcs;
+        double ms = 0.0;
+        cout.setstate(ios_base::failbit); // silence the TTC printout
+        for (auto &sample : samples)
+        {
+            double ttc;
+            double t = (double)cv::getTickCount();
+            computeTTCCamera(sample.kptsPrev, sample.kptsCurr, sample.boxMatches, frameRate, ttc, mode.options);
+            ms += elapsedMs(t);
+            ttcs.push_back(ttc);
+        }
+        cout.clear();
+        if (ttcExact.empty())
+        {
+            ttcExact = ttcs;
+        }
+
+        // deviation from the exact estimate, frames without a valid estimate in both modes are skipped
+        double sumDiff = 0.0, maxRelDiff = 0.0;
+        int nValid = 0;
+        for (size_t i = 0; i < ttcs.size(); ++i)
+        {
+            if (std::isfinite(ttcs[i]) && std::isfinite(ttcExact[i]))
+            {
+                double diff = fabs(ttcs[i] - ttcExact[i]);
+                sumDiff += diff;
+                maxRelDiff = max(maxRelDiff, diff / fabs(ttcExact[i]));
+                ++nValid;
+            }
+        }
+        cout << setw(20) << left << mode.name << right << " | " << fixed << setprecision(3) << setw(9) << ms / samples.size()
+             << " | " << setw(18) << mode.ratiosStored << " | " << setw(9) << sumDiff / max(1, nValid) << " s | "
+             << setprecision(4) << maxRelDiff << endl;
+    }
+}
+REGISTER_BENCHMARK("camera-ttc", "speed and accuracy of the camera TTC estimator modes over the KITTI sequence", benchmarkCameraTTC);
@@ -0,0 +1,82 @@
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "dataStructures.h"
+#include "frameRingBuffer.hpp"
+
+using namespace std;
+
+// fills a frame with data of the size produced by the pipeline for a KITTI image, re-using the buffers the frame already owns
+static void fillFrame(DataFrame &frame, int frameIdx)
+{
+    frame.cameraImg.create(375, 1242, CV_8UC3);
+    frame.cameraImg.setTo(cv::Scalar(frameIdx % 255));
+
+    frame.keypoints.resize(2000, cv::KeyPoint(100.0f, 100.0f, 4.0f));
+    frame.descriptors.create(2000, 64, CV_8U);
+    frame.descriptors.setTo(cv::Scalar(frameIdx % 255));
+    frame.kptMatches.resize(1500, cv::DMatch(0, 0, 1.0f));
+
+    frame.lidarPoints.clear();
+    for (int i = 0; i < 400; ++i)
+    {
+        frame.lidarPoints.push_back(10.0f, 0.0f, -1.0f, 0.5f);
+    }
+
+    frame.boundingBoxes.resize(10);
+    for (size_t i = 0; i < frame.boundingBoxes.size(); ++i)
+    {
+        frame.boundingBoxes[i].boxID = (int)i;
+        frame.boundingBoxes[i].roi = cv::Rect(100 * i, 100, 80, 60);
+    }
+    frame.bbMatches[0] = 0;
+}
+
+// memory use of the old push_back-only vector compared with the fixed-capacity ring buffer over a long drive
+static void benchmarkDataBufferMemory(const BenchmarkContext &context)
+{
+    int nFrames = 5000;
+    int reportInterval = 1000;
+    int nVectorFrames = 100; // the vector keeps every frame, so only a short sequence is feasible
+
+    cout << "vector<DataFrame> with push_back:" << endl;
+    double baseMemory = residentMemoryMB();
+    {
+        vector<DataFrame> dataBuffer;
+        double t = (double)cv::getTickCount();
+        for (int i = 0; i < nVectorFrames; ++i)
+        {
+            DataFrame frame;
+            fillFrame(frame, i);
+            dataBuffer.push_back(frame);
+            if ((i + 1) % 25 == 0)
+            {
+                cout << "  after " << setw(5) << i + 1 << " frames : " << fixed << setprecision(1) << residentMemoryMB() - baseMemory << " MB" << endl;
+            }
+        }
+        cout << "  " << elapsedMs(t) / nVectorFrames << " ms/frame" << endl;
+    }
+
+    cout << "FrameRingBuffer<DataFrame, 2> with recycled slots:" << endl;
+    baseMemory = residentMemoryMB();
+    {
+        FrameRingBuffer<DataFrame, 2> dataBuffer;
+        DataFrame frame; // receives the evicted frame, whose buffers are filled with the next frame
+        double t = (double)cv::getTickCount();
+        for (int i = 0; i < nFrames; ++i)
+        {
+            frame.clear();
+            fillFrame(frame, i);
+            dataBuffer.push(frame);
+            if ((i + 1) % reportInterval == 0 || i + 1 == nVectorFrames)
+            {
+                cout << "  after " << setw(5) << i + 1 << " frames : " << fixed << setprecision(1) << residentMemoryMB() - baseMemory << " MB" << endl;
+            }
+        }
+        cout << "  " << elapsedMs(t) / nFrames << " ms/frame" << endl;
+    }
+}
+REGISTER_BENCHMARK("data-buffer", "memory of the DataFrame history over a long sequence", benchmarkDataBufferMemory);
@@ -0,0 +1,126 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "benchmark.hpp"
+#include "featurePipeline.hpp"
+#include "matching2D.hpp"
+
+using namespace std;
+
+// per-frame cost of creating detector, extractor and matcher (as the free functions of matching2D do) compared to
+// a feature pipeline which creates them once, for all valid detector / descriptor combinations
+static void benchmarkFeaturePipeline(const BenchmarkContext &context)
+{
+    int nFrames = 10;
+    int nSetupRuns = 20;
+    vector<cv::Mat> images;
+    for (int i = 0; i < nFrames; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+    }
+
+    // Harris is left out, it has no setup cost and its runtime is dominated by the non-maximum suppression
+    const DetectorType detectors[] = {DetectorType::ShiTomasi, DetectorType::FAST, DetectorType::BRISK,
+                                      DetectorType::ORB, DetectorType::AKAZE, DetectorType::SIFT};
+    const DescriptorType descriptors[] = {DescriptorType::BRISK, DescriptorType::BRIEF, DescriptorType::ORB,
+                                          DescriptorType::FREAK, DescriptorType::AKAZE, DescriptorType::SIFT};
+
+    cout << nFrames << " KITTI frames, KNN selector" << endl;
+    cout << "detector  | descriptor | matcher   | setup ms | per-call ms/frame | cached ms/frame | saved" << endl;
+    for (DetectorType detectorType : detectors)
+    {
+        for (DescriptorType descriptorType : descriptors)
+        {
+            // AKAZE descriptors need AKAZE keypoints, ORB descriptors fail on the octaves of SIFT keypoints
+            if ((descriptorType == DescriptorType::AKAZE && detectorType != DetectorType::AKAZE) ||
+                (descriptorType == DescriptorType::ORB && detectorType == DetectorType::SIFT))
+            {
+                continue;
+            }
+            // matchDescriptors always uses the Hamming norm for brute force matching, float SIFT descriptors go to FLANN
+            MatcherType matcherType = descriptorType == DescriptorType::SIFT ? MatcherType::FLANN : MatcherType::BruteForce;
+            FeaturePipelineConfig config(detectorType, descriptorType, matcherType, SelectorType::KNN);
+            string detectorName = detectorTypeName(detectorType), descriptorName = descriptorTypeName(descriptorType);
+
+            // construction of detector, extractor and matcher alone
+            double t = (double)cv::getTickCount();
+            for (int run = 0; run < nSetupRuns; ++run)
+            {
+                FeaturePipeline pipeline(config);
+            }
+            double setupMs = elapsedMs(t) / nSetupRuns;
+
+            cout.setstate(ios_base::failbit); // silence the printouts of the detector and matcher
+
+            // free functions which create their objects on every call
+            size_t nMatchesPerCall = 0;
+            vector<cv::KeyPoint> kptsPrev;
+            cv::Mat descPrev;
+            t = (double)cv::getTickCount();
+            for (int i = 0; i < nFrames; ++i)
+            {
+                vector<cv::KeyPoint> kptsCurr;
+                cv::Mat descCurr;
+                if (detectorType == DetectorType::ShiTomasi)
+                {
+                    detKeypointsShiTomasi(kptsCurr, images[i], false);
+                }
+                else
+                {
+                    detKeypointsModern(kptsCurr, images[i], detectorName, false);
+                }
+                descKeypoints(kptsCurr, images[i], descCurr, descriptorName);
+                if (i > 0)
+                {
+                    vector<cv::DMatch> matches;
+                    matchDescriptors(kptsPrev, kptsCurr, descPrev, descCurr, matches, descriptorName,
+                                     matcherTypeName(matcherType), "SEL_KNN");
+                    nMatchesPerCall += matches.size();
+                }
+                kptsPrev.swap(kptsCurr);
+                descPrev = descCurr;
+            }
+            double perCallMs = elapsedMs(t) / nFrames;
+
+            // pipeline created once, as in the tracking application
+            size_t nMatchesCached = 0;
+            t = (double)cv::getTickCount();
+            FeaturePipeline pipeline(config);
+            kptsPrev.clear();
+            descPrev = cv::Mat();
+            for (int i = 0; i < nFrames; ++i)
+            {
+                vector<cv::KeyPoint> kptsCurr;
+                cv::Mat descCurr;
+                pipeline.detect(images[i], kptsCurr);
+                pipeline.describe(images[i], kptsCurr, descCurr);
+                if (i > 0)
+                {
+                    vector<cv::DMatch> matches;
+                    pipeline.match(descPrev, descCurr, matches);
+                    nMatchesCached += matches.size();
+                }
+                kptsPrev.swap(kptsCurr);
+                descPrev = descCurr;
+            }
+            double cachedMs = elapsedMs(t) / nFrames;
+            cout.clear();
+
+            cout << setw(9) << left << detectorName << " | " << setw(10) << descriptorName << " | " << setw(9)
+                 << matcherTypeName(matcherType) << right << " | " << fixed << setprecision(3) << setw(8) << setupMs << " | "
+                 << setw(17) << perCallMs << " | " << setw(15) << cachedMs << " | " << setprecision(1) << setw(4)
+                 << 100.0 * (perCallMs - cachedMs) / perCallMs << " %";
+            if (nMatchesPerCall != nMatchesCached)
+            {
+                cout << " (matches differ: " << nMatchesPerCall << " vs. " << nMatchesCached << ")";
+            }
+            cout << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("feature-pipeline", "per-frame setup cost of the keypoint detectors, extractors and matchers", benchmarkFeaturePipeline);
@@ -0,0 +1,124 @@
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <stdexcept>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "benchmark.hpp"
+#include "camFusion.hpp"
+#include "featurePipeline.hpp"
+#include "guidedMatcher.hpp"
+
+using namespace std;
+
+// matching time, no. of matches, share of implausibly long matches and the camera TTC of the vehicle ahead with the
+// comparisons restricted to a search radius, against matching all descriptors; no motion prediction, as that needs tracks.
+// Fails if a guided match connects keypoints further apart than the search radius
+static void benchmarkGuidedMatching(const BenchmarkContext &context)
+{
+    double frameRate = 10.0;
+    const float maxPlausibleShift = 100.0f; // [pixels] keypoints do not move further between two frames at 10 Hz
+    BoundingBox egoBox = syntheticBoxes(1)[0];
+    struct Combination { DetectorType detector; DescriptorType descriptor; };
+    const Combination combinations[] = {{DetectorType::ShiTomasi, DescriptorType::BRISK}, {DetectorType::FAST, DescriptorType::BRIEF},
+                                        {DetectorType::ORB, DescriptorType::ORB}, {DetectorType::AKAZE, DescriptorType::AKAZE},
+                                        {DetectorType::SIFT, DescriptorType::SIFT}};
+    const float radii[] = {0.0f, 80.0f, 40.0f, 20.0f}; // 0 : all descriptors are compared
+
+    vector<cv::Mat> images;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+    }
+
+    cout << "descriptor | search radius | ms/pair | matches/pair | candidates/kpt | long matches | mean |dTTC|" << endl;
+    for (const Combination &combination : combinations)
+    {
+        FeaturePipeline extraction(FeaturePipelineConfig(combination.detector, combination.descriptor));
+        vector<vector<cv::KeyPoint>> keypoints(kittiSequenceLength);
+        vector<cv::Mat> descriptors(kittiSequenceLength);
+        cout.setstate(ios_base::failbit); // silence the printouts of the extractor
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            extraction.detect(images[i], keypoints[i]);
+            extraction.describe(images[i], keypoints[i], descriptors[i]);
+        }
+        cout.clear();
+
+        vector<double> ttcAll;
+        for (float radius : radii)
+        {
+            GuidedMatcher guided(radius > 0.0f ? radius : 1.0f);
+            vector<double> ttcs;
+            double ms = 0.0, candidates = 0.0;
+            size_t nMatches = 0, nLong = 0;
+            cout.setstate(ios_base::failbit); // silence the printouts of the matcher and TTC
+            for (int i = 1; i < kittiSequenceLength; ++i)
+            {
+                vector<cv::DMatch> matches;
+                double t = (double)cv::getTickCount();
+                if (radius > 0.0f)
+                {
+                    guided.match(keypoints[i - 1], keypoints[i], descriptors[i - 1], descriptors[i], vector<cv::Point2f>(), matches);
+                    candidates += guided.meanCandidates();
+                }
+                else
+                { // brute force as configured in the final project
+                    extraction.match(descriptors[i - 1], descriptors[i], matches);
+                    candidates += descriptors[i - 1].rows;
+                }
+                ms += elapsedMs(t);
+                nMatches += matches.size();
+                for (auto &match : matches)
+                {
+                    cv::Point2f d = keypoints[i][match.trainIdx].pt - keypoints[i - 1][match.queryIdx].pt;
+                    nLong += d.x * d.x + d.y * d.y > maxPlausibleShift * maxPlausibleShift;
+                    if (radius > 0.0f && d.x * d.x + d.y * d.y > radius * radius)
+                    {
+                        cout.clear();
+                        throw runtime_error("guided-matching: a match lies outside the search radius");
+                    }
+                }
+
+                double ttc = NAN;
+                BoundingBox box = egoBox;
+                clusterKptMatchesWithROI(box, keypoints[i - 1], keypoints[i], matches);
+                computeTTCCamera(keypoints[i - 1], keypoints[i], box.kptMatches, frameRate, ttc, CameraTTCOptions());
+                ttcs.push_back(ttc);
+            }
+            cout.clear();
+            if (radius == 0.0f)
+            {
+                ttcAll = ttcs;
+            }
+
+            // deviation from the TTC with all descriptors compared, frames without a valid estimate in both runs are skipped
+            double sumDiff = 0.0;
+            int nValid = 0;
+            for (size_t i = 0; i < ttcs.size(); ++i)
+            {
+                if (std::isfinite(ttcs[i]) && std::isfinite(ttcAll[i]))
+                {
+                    sumDiff += fabs(ttcs[i] - ttcAll[i]);
+                    ++nValid;
+                }
+            }
+            int nPairs = kittiSequenceLength - 1;
+            cout << setw(10) << left << descriptorTypeName(combination.descriptor) << right << " | " << setw(13);
+            if (radius > 0.0f)
+                cout << fixed << setprecision(0) << radius;
+            else
+                cout << "all";
+            cout << " | " << fixed << setprecision(3) << setw(7) << ms / nPairs << " | " << setw(12) << nMatches / nPairs
+                 << " | " << setprecision(1) << setw(14) << candidates / nPairs << " | " << setprecision(2) << setw(10)
+                 << 100.0 * nLong / max((size_t)1, nMatches) << " % | " << setprecision(3) << setw(9) << sumDiff / max(1, nValid)
+                 << " s" << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("guided-matching", "windowed keypoint matching vs. matching all descriptors of two KITTI frames", benchmarkGuidedMatching);
@@ -0,0 +1,117 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "benchmark.hpp"
+#include "featurePipeline.hpp"
+#include "hammingMatcher.hpp"
+
+using namespace std;
+
+// KNN matching with ratio test as in matchDescriptors : cv::BFMatcher with k=2, then a second pass over the candidates
+static void matchBFReference(const cv::Ptr<cv::DescriptorMatcher> &matcher, const cv::Mat &descSource, const cv::Mat &descRef,
+                             vector<cv::DMatch> &matches)
+{
+    vector<vector<cv::DMatch>> matches_knn;
+    matcher->knnMatch(descSource, descRef, matches_knn, 2);
+    for (auto it = matches_knn.begin(); it != matches_knn.end(); ++it)
+    {
+        if (it->size() > 1 && (*it)[0].distance < 0.8 * (*it)[1].distance)
+            matches.push_back((*it)[0]);
+    }
+}
+
+static bool sameMatches(const vector<cv::DMatch> &a, const vector<cv::DMatch> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i].queryIdx != b[i].queryIdx || a[i].trainIdx != b[i].trainIdx || a[i].distance != b[i].distance)
+            return false;
+    }
+    return true;
+}
+
+// cv::BFMatcher against the Hamming matcher kernels on binary descriptors of consecutive KITTI frames
+static void benchmarkHammingMatcher(const BenchmarkContext &context)
+{
+    int nFrames = 20;
+    struct Combination { DetectorType detector; DescriptorType descriptor; };
+    const Combination combinations[] = {{DetectorType::ShiTomasi, DescriptorType::BRISK}, {DetectorType::FAST, DescriptorType::BRIEF},
+                                        {DetectorType::ORB, DescriptorType::ORB}, {DetectorType::BRISK, DescriptorType::FREAK},
+                                        {DetectorType::AKAZE, DescriptorType::AKAZE}};
+    vector<cv::Mat> images;
+    for (int i = 0; i < nFrames; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+    }
+
+    ThreadPool pool4(4), pool16(16);
+    cout << nFrames - 1 << " pairs of KITTI frames, best kernel on this CPU : " << hammingKernelName(HammingKernel::Auto) << endl;
+    cout << "descriptor | bytes | descriptors/frame | matcher         | ms/pair | identical" << endl;
+    for (const Combination &combination : combinations)
+    {
+        FeaturePipeline pipeline(FeaturePipelineConfig(combination.detector, combination.descriptor));
+        vector<cv::Mat> descriptors;
+        size_t nDescriptors = 0;
+        cout.setstate(ios_base::failbit); // silence the printouts of the extractor
+        for (auto &img : images)
+        {
+            vector<cv::KeyPoint> keypoints;
+            cv::Mat desc;
+            pipeline.detect(img, keypoints);
+            pipeline.describe(img, keypoints, desc);
+            descriptors.push_back(desc);
+            nDescriptors += desc.rows;
+        }
+        cout.clear();
+
+        // reference
+        cv::Ptr<cv::DescriptorMatcher> bfMatcher = cv::BFMatcher::create(cv::NORM_HAMMING, false);
+        vector<vector<cv::DMatch>> referenceMatches(nFrames - 1);
+        double t = (double)cv::getTickCount();
+        for (int i = 1; i < nFrames; ++i)
+        {
+            matchBFReference(bfMatcher, descriptors[i - 1], descriptors[i], referenceMatches[i - 1]);
+        }
+        double msReference = elapsedMs(t) / (nFrames - 1);
+
+        string descriptorName = descriptorTypeName(combination.descriptor);
+        cout << setw(10) << left << descriptorName << right << " | " << setw(5) << descriptors[0].cols << " | " << setw(17)
+             << nDescriptors / nFrames << " | " << setw(15) << left << "cv::BFMatcher" << right << " | " << fixed
+             << setprecision(3) << setw(7) << msReference << " |" << endl;
+
+        struct Variant { HammingKernel kernel; ThreadPool *pool; };
+        const Variant variants[] = {{HammingKernel::Scalar, nullptr}, {HammingKernel::Popcnt, nullptr}, {HammingKernel::AVX2, nullptr},
+                                    {HammingKernel::Auto, &pool4}, {HammingKernel::Auto, &pool16}};
+        for (const Variant &variant : variants)
+        {
+            if (!isHammingKernelSupported(variant.kernel))
+            {
+                continue;
+            }
+            HammingMatcher matcher(0.8, variant.kernel, variant.pool);
+            int nDifferent = 0;
+            double ms = 0.0;
+            for (int i = 1; i < nFrames; ++i)
+            {
+                vector<cv::DMatch> matches;
+                t = (double)cv::getTickCount();
+                matcher.match(descriptors[i - 1], descriptors[i], matches);
+                ms += elapsedMs(t);
+                nDifferent += !sameMatches(matches, referenceMatches[i - 1]);
+            }
+            string name = string(hammingKernelName(variant.kernel)) +
+                          (variant.pool ? ", " + to_string(variant.pool->size()) + " threads" : "");
+            cout << setw(10) << "" << " | " << setw(5) << "" << " | " << setw(17) << "" << " | " << setw(15) << left << name
+                 << right << " | " << setw(7) << ms / (nFrames - 1) << " | " << (nDifferent == 0 ? "yes" : "no") << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("hamming-matcher", "cv::BFMatcher vs. popcount Hamming matcher on KITTI binary descriptors", benchmarkHammingMatcher);
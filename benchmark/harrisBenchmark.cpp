@@ -0,0 +1,110 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "benchmark.hpp"
+#include "matching2D.hpp"
+
+using namespace std;
+
+// Harris detector as it was before the grid-based non-maximum suppression : element-wise threshold scan and a
+// comparison of every new key point with all key points found so far
+static void detKeypointsHarrisReference(vector<cv::KeyPoint> &keypoints, const cv::Mat &img)
+{
+    int blockSize = 4;
+    int apertureSize = 3;
+    int minResponse = 100;
+    double k = 0.04;
+
+    cv::Mat dst, dst_norm, dst_norm_scaled;
+    dst = cv::Mat::zeros(img.size(), CV_32FC1);
+    cv::cornerHarris(img, dst, blockSize, apertureSize, k, cv::BORDER_DEFAULT);
+    cv::normalize(dst, dst_norm, 0, 255, cv::NORM_MINMAX, CV_32FC1, cv::Mat());
+    cv::convertScaleAbs(dst_norm, dst_norm_scaled);
+
+    double maxOverlap = 0.0;
+    for (int j = 0; j < dst_norm.rows; j++)
+    {
+        for (int i = 0; i < dst_norm.cols; i++)
+        {
+            int response = (int)dst_norm.at<float>(j, i);
+            if (response > minResponse)
+            {
+                cv::KeyPoint newKeyPoint;
+                newKeyPoint.pt = cv::Point2f(i, j);
+                newKeyPoint.size = 2 * apertureSize;
+                newKeyPoint.response = response;
+
+                bool bOverlap = false;
+                for (auto it = keypoints.begin(); it != keypoints.end(); ++it)
+                {
+                    double keyptsOverlap = cv::KeyPoint::overlap(newKeyPoint, *it);
+                    if (keyptsOverlap > maxOverlap)
+                    {
+                        bOverlap = true;
+                        if (newKeyPoint.response > (*it).response)
+                        {
+                            *it = newKeyPoint;
+                            break;
+                        }
+                    }
+                }
+                if (!bOverlap)
+                    keypoints.push_back(newKeyPoint);
+            }
+        }
+    }
+}
+
+static bool sameKeypoints(const vector<cv::KeyPoint> &a, const vector<cv::KeyPoint> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i].pt != b[i].pt || a[i].response != b[i].response || a[i].size != b[i].size)
+            return false;
+    }
+    return true;
+}
+
+// Harris detection with pairwise and grid-based non-maximum suppression on the KITTI sequence
+static void benchmarkHarris(const BenchmarkContext &context)
+{
+    double msReference = 0.0, msGrid = 0.0, maxMsReference = 0.0, maxMsGrid = 0.0;
+    size_t nKeypoints = 0, maxKeypoints = 0;
+    int nDifferent = 0;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+
+        vector<cv::KeyPoint> kptsReference, kptsGrid;
+        double t = (double)cv::getTickCount();
+        detKeypointsHarrisReference(kptsReference, imgGray);
+        double ms = elapsedMs(t);
+        msReference += ms;
+        maxMsReference = max(maxMsReference, ms);
+
+        t = (double)cv::getTickCount();
+        detKeypointsHarris(kptsGrid, imgGray, false);
+        ms = elapsedMs(t);
+        msGrid += ms;
+        maxMsGrid = max(maxMsGrid, ms);
+
+        nKeypoints += kptsGrid.size();
+        maxKeypoints = max(maxKeypoints, kptsGrid.size());
+        nDifferent += !sameKeypoints(kptsReference, kptsGrid);
+    }
+
+    cout << kittiSequenceLength << " KITTI frames, " << nKeypoints / kittiSequenceLength << " Harris keypoints on average, "
+         << maxKeypoints << " at most" << endl;
+    cout << "NMS              | mean ms/frame | max. ms/frame" << endl;
+    cout << "pairwise overlap | " << fixed << setprecision(3) << setw(13) << msReference / kittiSequenceLength << " | "
+         << setw(13) << maxMsReference << endl;
+    cout << "grid cells       | " << setw(13) << msGrid / kittiSequenceLength << " | " << setw(13) << maxMsGrid << endl;
+    cout << "frames with different keypoints : " << nDifferent << endl;
+}
+REGISTER_BENCHMARK("harris", "Harris detector with pairwise and grid-based non-maximum suppression on the KITTI sequence", benchmarkHarris);
@@ -0,0 +1,112 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include "benchmark.hpp"
+#include "featurePipeline.hpp"
+#include "imageCache.hpp"
+
+using namespace std;
+
+// time per frame of the grayscale conversion and the optical flow pyramid built into new buffers, as the stages did
+// before, against the per-frame image cache of recycled frames; and the descriptor extraction on the colour image,
+// which converts it once more, against the extraction on the cached grayscale image
+static void benchmarkImageCache(const BenchmarkContext &context)
+{
+    int nFrames = 20, nRepetitions = 10;
+    vector<cv::Mat> images;
+    for (int i = 0; i < nFrames; ++i)
+    {
+        images.push_back(cv::imread(kittiImageFile(context, i)));
+    }
+    const int nRecycled = 3; // frames in flight, their caches are re-used round-robin like the recycled data frames
+    KltTrackingOptions klt;
+
+    // grayscale image and pyramid into new buffers for every frame
+    double t = (double)cv::getTickCount();
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (auto &img : images)
+        {
+            cv::Mat imgGray;
+            cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        }
+    }
+    double msGrayNew = elapsedMs(t) / (nRepetitions * nFrames);
+    t = (double)cv::getTickCount();
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (auto &img : images)
+        {
+            cv::Mat imgGray;
+            vector<cv::Mat> pyramid;
+            cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+            cv::buildOpticalFlowPyramid(imgGray, pyramid, cv::Size(klt.winSize, klt.winSize), klt.maxLevel);
+        }
+    }
+    double msPyramidNew = elapsedMs(t) / (nRepetitions * nFrames) - msGrayNew;
+
+    // the same from the image caches
+    vector<ImageCache> caches(nRecycled);
+    double msGrayCached = 0.0, msPyramidCached = 0.0;
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (int i = 0; i < nFrames; ++i)
+        {
+            ImageCache &cache = caches[i % nRecycled];
+            cache.reset(images[i]);
+            t = (double)cv::getTickCount();
+            cache.gray();
+            msGrayCached += elapsedMs(t);
+            t = (double)cv::getTickCount();
+            cache.opticalFlowPyramid(klt.winSize, klt.maxLevel);
+            cache.gray(); // further users get the images without any work
+            cache.opticalFlowPyramid(klt.winSize, klt.maxLevel);
+            msPyramidCached += elapsedMs(t);
+        }
+    }
+    msGrayCached /= nRepetitions * nFrames;
+    msPyramidCached /= nRepetitions * nFrames;
+
+    cout << "ms/frame                  | new buffers | image cache" << endl;
+    cout << fixed << setprecision(3) << "grayscale conversion      | " << setw(11) << msGrayNew << " | " << setw(11) << msGrayCached << endl;
+    cout << "optical flow pyramid      | " << setw(11) << msPyramidNew << " | " << setw(11) << msPyramidCached << endl;
+
+    // extraction on the colour image converts it internally
+    cout << endl << "descriptor | ms/frame colour | ms/frame gray | saved | same descriptors" << endl;
+    for (DescriptorType descriptor : {DescriptorType::BRISK, DescriptorType::ORB, DescriptorType::AKAZE, DescriptorType::SIFT})
+    {
+        DetectorType detector = descriptor == DescriptorType::AKAZE ? DetectorType::AKAZE
+                              : descriptor == DescriptorType::SIFT ? DetectorType::SIFT : DetectorType::ShiTomasi;
+        FeaturePipeline pipeline(FeaturePipelineConfig(detector, descriptor));
+        double msColour = 0.0, msGray = 0.0;
+        bool bSame = true;
+        cout.setstate(ios_base::failbit); // silence the printouts of the detector and extractor
+        for (int i = 0; i < nFrames; ++i)
+        {
+            ImageCache &cache = caches[i % nRecycled];
+            cache.reset(images[i]);
+            vector<cv::KeyPoint> keypoints;
+            pipeline.detect(cache.gray(), keypoints);
+
+            vector<cv::KeyPoint> kptsColour = keypoints, kptsGray = keypoints;
+            cv::Mat descColour, descGray;
+            t = (double)cv::getTickCount();
+            pipeline.describe(cache.color(), kptsColour, descColour);
+            msColour += elapsedMs(t);
+            t = (double)cv::getTickCount();
+            pipeline.describe(cache.gray(), kptsGray, descGray);
+            msGray += elapsedMs(t);
+            bSame = bSame && descColour.size() == descGray.size() && cv::norm(descColour, descGray, cv::NORM_L1) == 0.0;
+        }
+        cout.clear();
+        cout << setw(10) << left << descriptorTypeName(descriptor) << right << " | " << setw(15) << msColour / nFrames << " | "
+             << setw(13) << msGray / nFrames << " | " << setw(5) << (msColour - msGray) / nFrames << " | "
+             << (bSame ? "yes" : "no") << endl;
+    }
+}
+REGISTER_BENCHMARK("image-cache", "grayscale and pyramid built once into re-used buffers vs. per stage into new buffers", benchmarkImageCache);
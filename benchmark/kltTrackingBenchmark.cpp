@@ -0,0 +1,147 @@
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "benchmark.hpp"
+#include "camFusion.hpp"
+#include "featurePipeline.hpp"
+#include "lidarData.hpp"
+
+using namespace std;
+
+// latency of the correspondences and camera TTC of the vehicle ahead with optical flow tracking instead of descriptor
+// extraction and matching; the TTC is compared with the descriptor path and with the Lidar TTC (median distance)
+static void benchmarkKltTracking(const BenchmarkContext &context)
+{
+    double frameRate = 10.0;
+    BoundingBox egoBox = syntheticBoxes(1)[0];
+
+    // Lidar TTC of the vehicle ahead as a reference which does not depend on the keypoints
+    cv::Mat P_rect_00, R_rect_00, RT;
+    loadKittiCalibration(P_rect_00, R_rect_00, RT);
+    LidarProjector projector(P_rect_00, R_rect_00, RT);
+    vector<LidarCloud> clouds(kittiSequenceLength);
+    RoiGridIndex shrunkenIndex;
+    shrunkenIndex.build(syntheticBoxes(1), 0.10);
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        LidarCloud lidarPoints;
+        loadLidarFromFile(lidarPoints, kittiLidarFile(context, i));
+        cropLidarPoints(lidarPoints, 2.0, 20.0, 2.0, -1.5, -0.9, 0.1);
+        vector<BoundingBox> boxes = syntheticBoxes(1);
+        clusterLidarWithROI(boxes, lidarPoints, shrunkenIndex, projector);
+        clouds[i] = boxes[0].lidarPoints;
+    }
+    vector<double> ttcLidar(kittiSequenceLength, NAN);
+    cout.setstate(ios_base::failbit); // silence the TTC printout
+    for (int i = 1; i < kittiSequenceLength; ++i)
+    {
+        if (!clouds[i - 1].empty() && !clouds[i].empty())
+        {
+            computeTTCLidar(clouds[i - 1], clouds[i], frameRate, ttcLidar[i], LidarDistanceOptions(LidarDistanceStatistic::Median));
+        }
+    }
+    cout.clear();
+
+    vector<cv::Mat> images;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+    }
+
+    struct Variant { string name; KltTrackingOptions klt; };
+    const Variant variants[] = {{"descriptors", KltTrackingOptions(false)},
+                                {"KLT >= 300", KltTrackingOptions(true, 300, 21, 3, 0.0f)},
+                                {"KLT >= 300, f-b", KltTrackingOptions(true, 300, 21, 3, 1.0f)},
+                                {"KLT >= 1000, f-b", KltTrackingOptions(true, 1000, 21, 3, 1.0f)},
+                                {"KLT >= 300, f-b, 2 lvl", KltTrackingOptions(true, 300, 15, 2, 1.0f)}};
+
+    cout << "Shi-Tomasi keypoints, BRISK descriptors with brute force KNN matching on " << kittiSequenceLength << " KITTI frames" << endl;
+    cout << "correspondences          | ms/frame | matches/frame | detections | box matches | TTC frames | mean |dTTC| desc. | mean |TTC - Lidar|" << endl;
+    vector<double> ttcDescriptors;
+    for (const Variant &variant : variants)
+    {
+        FeaturePipelineConfig config(DetectorType::ShiTomasi, DescriptorType::BRISK);
+        config.klt = variant.klt;
+        FeaturePipeline pipeline(config);
+
+        vector<double> ttcs(kittiSequenceLength, NAN);
+        double ms = 0.0;
+        size_t nMatches = 0, nBoxMatches = 0;
+        vector<cv::KeyPoint> kptsPrev;
+        cv::Mat descPrev;
+        cout.setstate(ios_base::failbit); // silence the printouts of the detector, extractor, matcher and TTC
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            vector<cv::KeyPoint> kptsCurr;
+            vector<cv::DMatch> matches;
+            cv::Mat descCurr;
+            double t = (double)cv::getTickCount();
+            if (variant.klt.enabled)
+            {
+                pipeline.track(images[i], kptsCurr, matches);
+            }
+            else
+            {
+                pipeline.detect(images[i], kptsCurr);
+                pipeline.describe(images[i], kptsCurr, descCurr);
+                if (i > 0)
+                {
+                    pipeline.match(descPrev, descCurr, matches);
+                }
+            }
+            ms += elapsedMs(t);
+            nMatches += matches.size();
+
+            if (i > 0)
+            {
+                BoundingBox box = egoBox;
+                clusterKptMatchesWithROI(box, kptsPrev, kptsCurr, matches);
+                nBoxMatches += box.kptMatches.size();
+                computeTTCCamera(kptsPrev, kptsCurr, box.kptMatches, frameRate, ttcs[i], CameraTTCOptions());
+            }
+            kptsPrev.swap(kptsCurr);
+            descPrev = descCurr;
+        }
+        cout.clear();
+        if (!variant.klt.enabled)
+        {
+            ttcDescriptors = ttcs;
+        }
+
+        // frames without a valid estimate in both series are skipped
+        double sumDiff = 0.0, sumLidarDiff = 0.0;
+        int nValid = 0, nLidarValid = 0, nTTC = 0;
+        for (int i = 1; i < kittiSequenceLength; ++i)
+        {
+            if (!std::isfinite(ttcs[i]))
+            {
+                continue;
+            }
+            ++nTTC;
+            if (std::isfinite(ttcDescriptors[i]))
+            {
+                sumDiff += fabs(ttcs[i] - ttcDescriptors[i]);
+                ++nValid;
+            }
+            if (std::isfinite(ttcLidar[i]))
+            {
+                sumLidarDiff += fabs(ttcs[i] - ttcLidar[i]);
+                ++nLidarValid;
+            }
+        }
+        int nPairs = kittiSequenceLength - 1;
+        int nDetections = variant.klt.enabled ? pipeline.redetections() : kittiSequenceLength;
+        cout << setw(24) << left << variant.name << right << " | " << fixed << setprecision(2) << setw(8)
+             << ms / kittiSequenceLength << " | " << setw(13) << nMatches / nPairs << " | " << setw(10) << nDetections << " | "
+             << setw(11) << nBoxMatches / nPairs << " | " << setw(10) << nTTC << " | " << setprecision(3) << setw(15)
+             << sumDiff / max(1, nValid) << " s | " << setw(16) << sumLidarDiff / max(1, nLidarValid) << " s" << endl;
+    }
+}
+REGISTER_BENCHMARK("klt-tracking", "latency and camera TTC of optical flow tracking vs. descriptor matching on KITTI frames", benchmarkKltTracking);
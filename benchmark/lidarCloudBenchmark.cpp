@@ -0,0 +1,182 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+#include "camFusion.hpp"
+
+using namespace std;
+
+// bounding box as it was before the structure-of-arrays cloud, holding its Lidar points as std::vector<LidarPoint>
+struct ReferenceBox
+{
+    int boxID;
+    cv::Rect roi;
+    vector<LidarPoint> lidarPoints;
+};
+
+// clusterLidarWithROI as it was before LidarCloud, kept as reference
+static void clusterLidarWithROIReference(vector<ReferenceBox> &boundingBoxes, vector<LidarPoint> &lidarPoints, float shrinkFactor, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT)
+{
+    cv::Mat X(4, 1, cv::DataType<double>::type);
+    cv::Mat Y(3, 1, cv::DataType<double>::type);
+
+    for (auto it1 = lidarPoints.begin(); it1 != lidarPoints.end(); ++it1)
+    {
+        X.at<double>(0, 0) = it1->x;
+        X.at<double>(1, 0) = it1->y;
+        X.at<double>(2, 0) = it1->z;
+        X.at<double>(3, 0) = 1;
+
+        Y = P_rect_xx * R_rect_xx * RT * X;
+        cv::Point pt;
+        pt.x = Y.at<double>(0, 0) / Y.at<double>(0, 2);
+        pt.y = Y.at<double>(1, 0) / Y.at<double>(0, 2);
+
+        vector<vector<ReferenceBox>::iterator> enclosingBoxes;
+        for (vector<ReferenceBox>::iterator it2 = boundingBoxes.begin(); it2 != boundingBoxes.end(); ++it2)
+        {
+            cv::Rect smallerBox;
+            smallerBox.x = (*it2).roi.x + shrinkFactor * (*it2).roi.width / 2.0;
+            smallerBox.y = (*it2).roi.y + shrinkFactor * (*it2).roi.height / 2.0;
+            smallerBox.width = (*it2).roi.width * (1 - shrinkFactor);
+            smallerBox.height = (*it2).roi.height * (1 - shrinkFactor);
+            if (smallerBox.contains(pt))
+            {
+                enclosingBoxes.push_back(it2);
+            }
+        }
+
+        if (enclosingBoxes.size() == 1)
+        {
+            enclosingBoxes[0]->lidarPoints.push_back(*it1);
+        }
+    }
+}
+
+// distance estimate of computeTTCLidar as it was before LidarCloud (two passes over the points, erase of outliers)
+static double filteredMeanXReference(vector<LidarPoint> &lidarPoints)
+{
+    double x_total = 0;
+    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    {
+        x_total = x_total + it->x;
+    }
+    double x_mean = x_total / lidarPoints.size();
+
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
+    {
+        if (fabs(x_mean - lidarPoints[i].x) >= 0.03 * x_mean)
+        {
+            lidarPoints.erase(lidarPoints.begin() + i);
+        }
+    }
+
+    x_total = 0;
+    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    {
+        x_total = x_total + it->x;
+    }
+    return x_total / lidarPoints.size();
+}
+
+// crop + cluster + TTC on std::vector<LidarPoint> compared with LidarCloud over all scans of the KITTI sequence
+static void benchmarkLidarCloud(const BenchmarkContext &context)
+{
+    cv::Mat P_rect_00, R_rect_00, RT;
+    loadKittiCalibration(P_rect_00, R_rect_00, RT);
+
+    float minZ = -1.5, maxZ = -0.9, minX = 2.0, maxX = 20.0, maxY = 2.0, minR = 0.1;
+    float shrinkFactor = 0.10;
+    double frameRate = 10.0;
+    vector<BoundingBox> boxes = syntheticBoxes(10);
+
+    // load all scans up front so that only the processing chain is timed
+    vector<vector<LidarPoint>> scansAoS(kittiSequenceLength);
+    vector<LidarCloud> scansSoA(kittiSequenceLength);
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        loadLidarFromFile(scansAoS[i], kittiLidarFile(context, i));
+        loadLidarFromFile(scansSoA[i], kittiLidarFile(context, i));
+    }
+
+    // array of structs
+    double tCrop = 0.0, tCluster = 0.0, tTTC = 0.0;
+    vector<double> ttcAoS;
+    vector<LidarPoint> prevPoints;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        vector<LidarPoint> lidarPoints = scansAoS[i];
+        double t = (double)cv::getTickCount();
+        cropLidarPoints(lidarPoints, minX, maxX, maxY, minZ, maxZ, minR);
+        tCrop += elapsedMs(t);
+
+        vector<ReferenceBox> refBoxes(boxes.size());
+        for (size_t b = 0; b < boxes.size(); ++b)
+        {
+            refBoxes[b].boxID = boxes[b].boxID;
+            refBoxes[b].roi = boxes[b].roi;
+        }
+        t = (double)cv::getTickCount();
+        clusterLidarWithROIReference(refBoxes, lidarPoints, shrinkFactor, P_rect_00, R_rect_00, RT);
+        tCluster += elapsedMs(t);
+
+        vector<LidarPoint> currPoints = refBoxes[0].lidarPoints;
+        if (i > 0 && !prevPoints.empty() && !currPoints.empty())
+        {
+            t = (double)cv::getTickCount();
+            vector<LidarPoint> prev = prevPoints, curr = currPoints;
+            double d0 = filteredMeanXReference(prev);
+            double d1 = filteredMeanXReference(curr);
+            ttcAoS.push_back(d0 * (1.0 / frameRate) / (d0 - d1));
+            tTTC += elapsedMs(t);
+        }
+        prevPoints = currPoints;
+    }
+    cout << "std::vector<LidarPoint> (" << sizeof(LidarPoint) << " bytes/point) : crop " << fixed << setprecision(3) << tCrop / kittiSequenceLength
+         << " ms, cluster " << tCluster / kittiSequenceLength << " ms, TTC " << tTTC / kittiSequenceLength << " ms, total "
+         << (tCrop + tCluster + tTTC) / kittiSequenceLength << " ms/frame" << endl;
+
+    // structure of arrays
+    tCrop = 0.0; tCluster = 0.0; tTTC = 0.0;
+    vector<double> ttcSoA;
+    LidarCloud prevCloud;
+    cout.setstate(ios_base::failbit); // silence the TTC printout of computeTTCLidar
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        LidarCloud lidarPoints = scansSoA[i];
+        double t = (double)cv::getTickCount();
+        cropLidarPoints(lidarPoints, minX, maxX, maxY, minZ, maxZ, minR);
+        tCrop += elapsedMs(t);
+
+        vector<BoundingBox> frameBoxes = boxes;
+        t = (double)cv::getTickCount();
+        clusterLidarWithROI(frameBoxes, lidarPoints, shrinkFactor, P_rect_00, R_rect_00, RT);
+        tCluster += elapsedMs(t);
+
+        const LidarCloud &currCloud = frameBoxes[0].lidarPoints;
+        if (i > 0 && !prevCloud.empty() && !currCloud.empty())
+        {
+            t = (double)cv::getTickCount();
+            double ttc;
+            computeTTCLidar(prevCloud, currCloud, frameRate, ttc);
+            ttcSoA.push_back(ttc);
+            tTTC += elapsedMs(t);
+        }
+        prevCloud = currCloud;
+    }
+    cout.clear();
+    size_t bytesPerPoint = 4 * sizeof(float);
+    cout << "LidarCloud (" << bytesPerPoint << " bytes/point)              : crop " << tCrop / kittiSequenceLength
+         << " ms, cluster " << tCluster / kittiSequenceLength << " ms, TTC " << tTTC / kittiSequenceLength << " ms, total "
+         << (tCrop + tCluster + tTTC) / kittiSequenceLength << " ms/frame" << endl;
+
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < min(ttcAoS.size(), ttcSoA.size()); ++i)
+    {
+        maxDiff = max(maxDiff, fabs(ttcAoS[i] - ttcSoA[i]));
+    }
+    cout << "max. TTC difference over " << ttcSoA.size() << " frames (the LidarCloud path also filters all outliers) : " << setprecision(6) << maxDiff << " s" << endl;
+}
+REGISTER_BENCHMARK("lidar-cloud", "crop + cluster + TTC chain, std::vector<LidarPoint> vs. LidarCloud", benchmarkLidarCloud);
@@ -0,0 +1,112 @@
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+
+using namespace std;
+
+// cropLidarPoints as it was before the SIMD kernels (copy of the survivors into a new vector), kept as reference
+static void cropLidarPointsReference(std::vector<LidarPoint> &lidarPoints, float minX, float maxX, float maxY, float minZ, float maxZ, float minR)
+{
+    std::vector<LidarPoint> newLidarPts;
+    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    {
+        if ((*it).x >= minX && (*it).x <= maxX && (*it).z >= minZ && (*it).z <= maxZ && (*it).z <= 0.0 && abs((*it).y) <= maxY && (*it).r >= minR)
+        {
+            newLidarPts.push_back(*it);
+        }
+    }
+    lidarPoints = newLidarPts;
+}
+
+static bool isBitIdentical(const vector<float> &a, const vector<float> &b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+}
+
+static void printThroughput(const string &name, double ms, size_t nPoints, int nScans)
+{
+    cout << setw(28) << left << name << right << fixed << setprecision(3) << setw(8) << ms / nScans << " ms/scan, "
+         << setprecision(1) << setw(8) << nPoints / (ms * 1000.0) << " Mpts/s" << endl;
+}
+
+// crop kernels over the full (uncropped) scans of the KITTI sequence, results are checked against the reference
+static void benchmarkLidarCrop(const BenchmarkContext &context)
+{
+    float minZ = -1.5, maxZ = -0.9, minX = 2.0, maxX = 20.0, maxY = 2.0, minR = 0.1;
+    int nRepetitions = 10;
+
+    vector<LidarCloud> scans(kittiSequenceLength);
+    vector<vector<LidarPoint>> expected(kittiSequenceLength);
+    size_t nPoints = 0;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        loadLidarFromFile(scans[i], kittiLidarFile(context, i));
+        scans[i].boxIDs.resize(scans[i].size());
+        for (size_t j = 0; j < scans[i].size(); ++j)
+        {
+            scans[i].boxIDs[j] = (int)j; // point index, so that the compaction order is checked as well
+        }
+        nPoints += scans[i].size();
+    }
+    cout << "average scan size : " << nPoints / kittiSequenceLength << " points" << endl;
+    int nScans = kittiSequenceLength * nRepetitions;
+
+    // reference, the input copy is part of the timing as the old function also allocated a new vector per call
+    double ms = 0.0;
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            toLidarPoints(scans[i], expected[i]);
+            double t = (double)cv::getTickCount();
+            cropLidarPointsReference(expected[i], minX, maxX, maxY, minZ, maxZ, minR);
+            ms += elapsedMs(t);
+        }
+    }
+    printThroughput("reference (copy)", ms, nPoints * nRepetitions, nScans);
+
+    CropKernel kernels[] = {CropKernel::Scalar, CropKernel::SSE, CropKernel::AVX2};
+    for (CropKernel kernel : kernels)
+    {
+        if (!isCropKernelSupported(kernel))
+        {
+            cout << setw(28) << left << cropKernelName(kernel) << right << "not supported by this CPU" << endl;
+            continue;
+        }
+
+        ms = 0.0;
+        bool bIdentical = true;
+        LidarCloud cloud;
+        for (int rep = 0; rep < nRepetitions; ++rep)
+        {
+            for (int i = 0; i < kittiSequenceLength; ++i)
+            {
+                cloud = scans[i];
+                double t = (double)cv::getTickCount();
+                cropLidarPoints(cloud, minX, maxX, maxY, minZ, maxZ, minR, kernel);
+                ms += elapsedMs(t);
+
+                if (rep == 0)
+                {
+                    LidarCloud ref;
+                    toLidarCloud(expected[i], ref);
+                    bool bOrder = cloud.boxIDs.size() == cloud.size();
+                    for (size_t j = 1; bOrder && j < cloud.size(); ++j)
+                    {
+                        bOrder = cloud.boxIDs[j - 1] < cloud.boxIDs[j];
+                    }
+                    bIdentical = bIdentical && bOrder && isBitIdentical(cloud.x, ref.x) && isBitIdentical(cloud.y, ref.y)
+                                 && isBitIdentical(cloud.z, ref.z) && isBitIdentical(cloud.r, ref.r);
+                }
+            }
+        }
+        printThroughput(string(cropKernelName(kernel)) + " (in place)", ms, nPoints * nRepetitions, nScans);
+        cout << "  results " << (bIdentical ? "bit-identical to the reference" : "DIFFER from the reference") << endl;
+    }
+    cout << "kernel selected at runtime : " << cropKernelName(CropKernel::Auto) << endl;
+}
+REGISTER_BENCHMARK("lidar-crop", "SIMD Lidar crop kernels vs. the reference crop over full KITTI scans", benchmarkLidarCrop);
@@ -0,0 +1,96 @@
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+
+using namespace std;
+
+// loader as it was before memory-mapping (malloc of a fixed 4 MB buffer, fread and push_back without reserve),
+// kept as reference; the buffer is released here so that the benchmark itself does not leak
+static void loadLidarFromFileReference(vector<LidarPoint> &lidarPoints, string filename)
+{
+    unsigned long num = 1000000;
+    float *data = (float*)malloc(num*sizeof(float));
+
+    float *px = data+0;
+    float *py = data+1;
+    float *pz = data+2;
+    float *pr = data+3;
+
+    FILE *stream;
+    stream = fopen (filename.c_str(),"rb");
+    num = fread(data,sizeof(float),num,stream)/4;
+
+    for (unsigned long i=0; i<num; i++) {
+        LidarPoint lpt;
+        lpt.x = *px; lpt.y = *py; lpt.z = *pz; lpt.r = *pr;
+        lidarPoints.push_back(lpt);
+        px+=4; py+=4; pz+=4; pr+=4;
+    }
+    fclose(stream);
+    free(data);
+}
+
+static void printThroughput(const string &name, double ms, size_t nPoints, int nScans)
+{
+    double mb = nPoints * sizeof(LidarRecord) / (1024.0 * 1024.0);
+    cout << setw(28) << left << name << right << fixed << setprecision(3) << setw(8) << ms / nScans << " ms/scan, "
+         << setprecision(1) << setw(8) << mb / (ms / 1000.0) << " MB/s, " << setw(6) << nPoints / (ms * 1000.0) << " Mpts/s" << endl;
+}
+
+// throughput of the Lidar loaders over all scans of the KITTI sequence (page cache warmed up by a first pass)
+static void benchmarkLidarLoader(const BenchmarkContext &context)
+{
+    int nRepetitions = 5;
+    size_t nPoints = 0;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        nPoints += LidarScan(kittiLidarFile(context, i)).size();
+    }
+    nPoints *= nRepetitions;
+    int nScans = kittiSequenceLength * nRepetitions;
+
+    double t = (double)cv::getTickCount();
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            vector<LidarPoint> lidarPoints;
+            loadLidarFromFileReference(lidarPoints, kittiLidarFile(context, i));
+        }
+    }
+    printThroughput("fread + push_back", elapsedMs(t), nPoints, nScans);
+
+    t = (double)cv::getTickCount();
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            vector<LidarPoint> lidarPoints;
+            loadLidarFromFile(lidarPoints, kittiLidarFile(context, i));
+        }
+    }
+    printThroughput("mmap + convert to LidarPoint", elapsedMs(t), nPoints, nScans);
+
+    // zero-copy access, every record is touched once so that the pages are actually read
+    t = (double)cv::getTickCount();
+    double sum = 0.0;
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            LidarScan scan(kittiLidarFile(context, i));
+            for (auto it = scan.begin(); it != scan.end(); ++it)
+            {
+                sum += it->x;
+            }
+        }
+    }
+    printThroughput("mmap span (zero-copy)", elapsedMs(t), nPoints, nScans);
+    cout << "(checksum " << sum << ")" << endl;
+}
+REGISTER_BENCHMARK("lidar-loader", "Velodyne .bin loader throughput over the KITTI scans", benchmarkLidarLoader);
@@ -0,0 +1,90 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+#include "lidarProjection.hpp"
+
+using namespace std;
+
+// per-point projection as done by clusterLidarWithROI and showLidarImgOverlay before LidarProjector, kept as reference
+static void projectLidarPointsReference(const LidarCloud &lidarPoints, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT, vector<cv::Point2d> &pixels)
+{
+    cv::Mat X(4, 1, cv::DataType<double>::type);
+    cv::Mat Y(3, 1, cv::DataType<double>::type);
+    pixels.resize(lidarPoints.size());
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
+    {
+        X.at<double>(0, 0) = lidarPoints.x[i];
+        X.at<double>(1, 0) = lidarPoints.y[i];
+        X.at<double>(2, 0) = lidarPoints.z[i];
+        X.at<double>(3, 0) = 1;
+
+        Y = P_rect_xx * R_rect_xx * RT * X;
+        pixels[i].x = Y.at<double>(0, 0) / Y.at<double>(0, 2);
+        pixels[i].y = Y.at<double>(1, 0) / Y.at<double>(0, 2);
+    }
+}
+
+// projected points per second over the full (uncropped) scans of the KITTI sequence
+static void benchmarkLidarProjection(const BenchmarkContext &context)
+{
+    cv::Mat P_rect_00, R_rect_00, RT;
+    loadKittiCalibration(P_rect_00, R_rect_00, RT);
+    LidarProjector projector(P_rect_00, R_rect_00, RT);
+
+    vector<LidarCloud> scans(kittiSequenceLength);
+    size_t nPoints = 0;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        loadLidarFromFile(scans[i], kittiLidarFile(context, i));
+        nPoints += scans[i].size();
+    }
+
+    // the reference is slow, so it only sees every 10th scan
+    size_t nRefPoints = 0;
+    double msRef = 0.0, maxDiff = 0.0;
+    size_t nValid = 0, nPixelDiff = 0;
+    vector<cv::Point2d> pixels;
+    LidarProjection projection;
+    for (int i = 0; i < kittiSequenceLength; i += 10)
+    {
+        double t = (double)cv::getTickCount();
+        projectLidarPointsReference(scans[i], P_rect_00, R_rect_00, RT, pixels);
+        msRef += elapsedMs(t);
+        nRefPoints += scans[i].size();
+
+        projector.project(scans[i], projection);
+        for (size_t j = 0; j < projection.size(); ++j)
+        {
+            if (!projection.valid[j])
+            {
+                continue;
+            }
+            ++nValid;
+            maxDiff = max(maxDiff, max(fabs(projection.u[j] - pixels[j].x), fabs(projection.v[j] - pixels[j].y)));
+            nPixelDiff += ((int)projection.u[j] != (int)pixels[j].x || (int)projection.v[j] != (int)pixels[j].y);
+        }
+    }
+
+    int nRepetitions = 10;
+    double ms = 0.0;
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            double t = (double)cv::getTickCount();
+            projector.project(scans[i], projection);
+            ms += elapsedMs(t);
+        }
+    }
+
+    cout << "average scan size            : " << nPoints / kittiSequenceLength << " points" << endl;
+    cout << "per-point cv::Mat (reference) : " << fixed << setprecision(2) << nRefPoints / (msRef * 1000.0) << " Mpts/s" << endl;
+    cout << "LidarProjector (batch)        : " << nPoints * nRepetitions / (ms * 1000.0) << " Mpts/s, "
+         << setprecision(3) << ms / (kittiSequenceLength * nRepetitions) << " ms/scan" << endl;
+    cout << "points in front of the camera : " << nValid << ", max. difference " << setprecision(6) << maxDiff << " px, "
+         << nPixelDiff << " points on a different integer pixel" << endl;
+}
+REGISTER_BENCHMARK("lidar-projection", "per-point cv::Mat projection vs. batched LidarProjector over full KITTI scans", benchmarkLidarProjection);
@@ -0,0 +1,136 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+#include "camFusion.hpp"
+
+using namespace std;
+
+// distance estimate of computeTTCLidar as it was before estimateLidarDistance, kept as reference; it erases the outliers
+// from the caller's points and does not check the point following an erased one
+static double filteredMeanXReference(vector<LidarPoint> &lidarPoints)
+{
+    double x_total = 0;
+    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    {
+        x_total = x_total + it->x;
+    }
+    double x_mean = x_total / lidarPoints.size();
+
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
+    {
+        if (fabs(x_mean - lidarPoints[i].x) >= 0.03 * x_mean)
+        {
+            lidarPoints.erase(lidarPoints.begin() + i);
+        }
+    }
+
+    x_total = 0;
+    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    {
+        x_total = x_total + it->x;
+    }
+    return x_total / lidarPoints.size();
+}
+
+// Lidar distance statistics: time per estimate and TTC of the vehicle ahead for every frame of the KITTI sequence
+static void benchmarkLidarTTC(const BenchmarkContext &context)
+{
+    cv::Mat P_rect_00, R_rect_00, RT;
+    loadKittiCalibration(P_rect_00, R_rect_00, RT);
+    LidarProjector projector(P_rect_00, R_rect_00, RT);
+    float minZ = -1.5, maxZ = -0.9, minX = 2.0, maxX = 20.0, maxY = 2.0, minR = 0.1;
+    double frameRate = 10.0;
+
+    // Lidar points on the vehicle ahead, as clustered by the tracking application
+    vector<LidarCloud> clouds(kittiSequenceLength);
+    RoiGridIndex shrunkenIndex;
+    shrunkenIndex.build(syntheticBoxes(1), 0.10);
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        LidarCloud lidarPoints;
+        loadLidarFromFile(lidarPoints, kittiLidarFile(context, i));
+        cropLidarPoints(lidarPoints, minX, maxX, maxY, minZ, maxZ, minR);
+        vector<BoundingBox> boxes = syntheticBoxes(1);
+        clusterLidarWithROI(boxes, lidarPoints, shrunkenIndex, projector);
+        clouds[i] = boxes[0].lidarPoints;
+    }
+
+    struct Estimator { string name; LidarDistanceOptions options; };
+    vector<Estimator> estimators = {
+        {"filtered", LidarDistanceOptions(LidarDistanceStatistic::FilteredMean)},
+        {"trimmed", LidarDistanceOptions(LidarDistanceStatistic::TrimmedMean)},
+        {"median", LidarDistanceOptions(LidarDistanceStatistic::Median)},
+        {"p10", LidarDistanceOptions(LidarDistanceStatistic::Percentile)}};
+
+    // microbenchmark, distance estimate per cloud
+    int nRepetitions = 200;
+    size_t nPoints = 0;
+    for (auto it = clouds.begin(); it != clouds.end(); ++it)
+    {
+        nPoints += it->size();
+    }
+    cout << nPoints / kittiSequenceLength << " Lidar points on the vehicle ahead on average" << endl;
+
+    double t = (double)cv::getTickCount();
+    double checksum = 0.0;
+    for (int rep = 0; rep < nRepetitions; ++rep)
+    {
+        for (auto it = clouds.begin(); it != clouds.end(); ++it)
+        {
+            vector<LidarPoint> lidarPoints;
+            toLidarPoints(*it, lidarPoints);
+            checksum += filteredMeanXReference(lidarPoints);
+        }
+    }
+    cout << setw(24) << left << "reference (erase)" << right << fixed << setprecision(2) << setw(8)
+         << 1000.0 * elapsedMs(t) / (nRepetitions * kittiSequenceLength) << " us/estimate (incl. the copy it needs)" << endl;
+    for (auto &estimator : estimators)
+    {
+        t = (double)cv::getTickCount();
+        for (int rep = 0; rep < nRepetitions; ++rep)
+        {
+            for (auto it = clouds.begin(); it != clouds.end(); ++it)
+            {
+                checksum += estimateLidarDistance(it->x, estimator.options);
+            }
+        }
+        cout << setw(24) << left << estimator.name << right << setw(8)
+             << 1000.0 * elapsedMs(t) / (nRepetitions * kittiSequenceLength) << " us/estimate" << endl;
+    }
+    cout << "(checksum " << checksum << ")" << endl;
+
+    // regression, TTC per frame for the reference and all statistics
+    cout << endl << "frame | points | reference";
+    for (auto &estimator : estimators)
+    {
+        cout << " | " << setw(8) << estimator.name;
+    }
+    cout << endl;
+    cout.precision(3);
+    for (int i = 1; i < kittiSequenceLength; ++i)
+    {
+        if (clouds[i - 1].empty() || clouds[i].empty())
+        {
+            continue;
+        }
+        vector<LidarPoint> prevPoints, currPoints;
+        toLidarPoints(clouds[i - 1], prevPoints);
+        toLidarPoints(clouds[i], currPoints);
+        double d0 = filteredMeanXReference(prevPoints), d1 = filteredMeanXReference(currPoints);
+        cout << setw(5) << i << " | " << setw(6) << clouds[i].size() << " | " << setw(9) << d0 * (1.0 / frameRate) / (d0 - d1);
+
+        for (auto &estimator : estimators)
+        {
+            double ttc;
+            cout.setstate(ios_base::failbit); // silence the TTC printout
+            computeTTCLidar(clouds[i - 1], clouds[i], frameRate, ttc, estimator.options);
+            cout.clear();
+            cout << " | " << setw(8) << ttc;
+        }
+        cout << endl;
+    }
+}
+REGISTER_BENCHMARK("lidar-ttc", "Lidar distance statistics: time per estimate and TTC per frame vs. the reference", benchmarkLidarTTC);
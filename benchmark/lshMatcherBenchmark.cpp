@@ -0,0 +1,131 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "benchmark.hpp"
+#include "featurePipeline.hpp"
+#include "hammingMatcher.hpp"
+#include "lshIndex.hpp"
+
+using namespace std;
+
+// KNN matching as in the MAT_FLANN branch of matchDescriptors : KD-tree over float copies of the binary descriptors
+static void matchFlannFloat(const cv::Mat &descSource, const cv::Mat &descRef, vector<cv::DMatch> &matches)
+{
+    cv::Mat source, ref;
+    descSource.convertTo(source, CV_32F);
+    descRef.convertTo(ref, CV_32F);
+    cv::Ptr<cv::DescriptorMatcher> matcher = cv::FlannBasedMatcher::create();
+    vector<vector<cv::DMatch>> matches_knn;
+    matcher->knnMatch(source, ref, matches_knn, 2);
+    for (auto it = matches_knn.begin(); it != matches_knn.end(); ++it)
+    {
+        if (it->size() > 1 && (*it)[0].distance < 0.8 * (*it)[1].distance)
+            matches.push_back((*it)[0]);
+    }
+}
+
+// recall : share of the exact matches which are found, precision : share of the matches found which are exact
+static void compareWithExact(const vector<cv::DMatch> &exact, const vector<cv::DMatch> &approx, int nQueries,
+                             size_t &nCorrect, size_t &nExact, size_t &nApprox)
+{
+    vector<int> exactTrainIdx(nQueries, -1);
+    for (auto &match : exact)
+    {
+        exactTrainIdx[match.queryIdx] = match.trainIdx;
+    }
+    for (auto &match : approx)
+    {
+        nCorrect += exactTrainIdx[match.queryIdx] == match.trainIdx;
+    }
+    nExact += exact.size();
+    nApprox += approx.size();
+}
+
+// latency, recall and precision of approximate matching of binary descriptors against brute force on KITTI frames
+static void benchmarkLshMatcher(const BenchmarkContext &context)
+{
+    int nFrames = 20;
+    struct Combination { DetectorType detector; DescriptorType descriptor; };
+    const Combination combinations[] = {{DetectorType::ShiTomasi, DescriptorType::BRISK}, {DetectorType::FAST, DescriptorType::BRIEF},
+                                        {DetectorType::ORB, DescriptorType::ORB}, {DetectorType::AKAZE, DescriptorType::AKAZE}};
+    struct Variant { string name; LshOptions options; bool bFloatFlann; size_t nThreads; };
+    const Variant variants[] = {{"KD-tree on floats", LshOptions(), true, 1},
+                                {"LSH 2 x 12 bits", LshOptions(2, 12, false), false, 1},
+                                {"LSH 6 x 12 bits", LshOptions(6, 12, false), false, 1},
+                                {"LSH 2 x 12, probe", LshOptions(2, 12, true), false, 1},
+                                {"LSH 6 x 12, probe", LshOptions(6, 12, true), false, 1},
+                                {"LSH 6 x 12, probe", LshOptions(6, 12, true), false, 4},
+                                {"LSH 8 x 16, probe", LshOptions(8, 16, true), false, 1}};
+
+    vector<cv::Mat> images;
+    for (int i = 0; i < nFrames; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+    }
+
+    cout << nFrames - 1 << " pairs of KITTI frames, ratio test 0.8" << endl;
+    cout << "descriptor | matcher              | threads | ms/pair | recall | precision" << endl;
+    for (const Combination &combination : combinations)
+    {
+        FeaturePipeline pipeline(FeaturePipelineConfig(combination.detector, combination.descriptor));
+        vector<cv::Mat> descriptors;
+        cout.setstate(ios_base::failbit); // silence the printouts of the extractor
+        for (auto &img : images)
+        {
+            vector<cv::KeyPoint> keypoints;
+            cv::Mat desc;
+            pipeline.detect(img, keypoints);
+            pipeline.describe(img, keypoints, desc);
+            descriptors.push_back(desc);
+        }
+        cout.clear();
+
+        // exact reference
+        HammingMatcher bruteForce;
+        vector<vector<cv::DMatch>> exactMatches(nFrames - 1);
+        double t = (double)cv::getTickCount();
+        for (int i = 1; i < nFrames; ++i)
+        {
+            bruteForce.match(descriptors[i - 1], descriptors[i], exactMatches[i - 1]);
+        }
+        double msBruteForce = elapsedMs(t) / (nFrames - 1);
+        string descriptorName = descriptorTypeName(combination.descriptor);
+        cout << setw(10) << left << descriptorName << " | " << setw(20) << "brute force" << right << " | " << setw(7) << 1
+             << " | " << fixed << setprecision(3) << setw(7) << msBruteForce << " | " << setw(6) << 1.0 << " | " << setw(9) << 1.0
+             << endl;
+
+        for (const Variant &variant : variants)
+        {
+            ThreadPool pool(variant.nThreads);
+            LshIndex index(variant.options);
+            size_t nCorrect = 0, nExact = 0, nApprox = 0;
+            double ms = 0.0;
+            for (int i = 1; i < nFrames; ++i)
+            {
+                vector<cv::DMatch> matches;
+                t = (double)cv::getTickCount();
+                if (variant.bFloatFlann)
+                {
+                    matchFlannFloat(descriptors[i - 1], descriptors[i], matches);
+                }
+                else
+                { // index built once per frame, as in the feature pipeline
+                    index.build(descriptors[i]);
+                    index.match(descriptors[i - 1], matches, 0.8, &pool);
+                }
+                ms += elapsedMs(t);
+                compareWithExact(exactMatches[i - 1], matches, descriptors[i - 1].rows, nCorrect, nExact, nApprox);
+            }
+            cout << setw(10) << "" << " | " << setw(20) << left << variant.name << right << " | " << setw(7) << variant.nThreads
+                 << " | " << setw(7) << ms / (nFrames - 1) << " | " << setw(6) << (double)nCorrect / max((size_t)1, nExact)
+                 << " | " << setw(9) << (double)nCorrect / max((size_t)1, nApprox) << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("lsh-matcher", "recall and latency of LSH and float KD-tree matching vs. brute force on KITTI binary descriptors", benchmarkLshMatcher);
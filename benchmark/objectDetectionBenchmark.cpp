@@ -0,0 +1,47 @@
+
+#include <iostream>
+#include <iomanip>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "benchmark.hpp"
+#include "objectDetection2D.hpp"
+
+using namespace std;
+
+// throughput of the YOLO detector on CPU for different batch sizes
+static void benchmarkDetectionBatchSize(const BenchmarkContext &context)
+{
+    int nImages = 16;
+    vector<cv::Mat> images;
+    for (int i = 0; i < nImages; ++i)
+    {
+        images.push_back(cv::imread(kittiImageFile(context, i)));
+    }
+
+    ObjectDetector detector(yoloFile(context, "coco.names"), yoloFile(context, "yolov3.cfg"), yoloFile(context, "yolov3.weights"));
+
+    // warm-up run so that network initialization is not attributed to the first batch size
+    vector<BoundingBox> warmupBoxes;
+    detector.detect(images[0], warmupBoxes);
+
+    int batchSizes[] = {1, 2, 4, 8, 16};
+    for (int batchSize : batchSizes)
+    {
+        size_t nDetections = 0;
+        double t = (double)cv::getTickCount();
+        for (int first = 0; first < nImages; first += batchSize)
+        {
+            vector<cv::Mat> batch(images.begin() + first, images.begin() + min(nImages, first + batchSize));
+            vector<vector<BoundingBox>> batchBoxes;
+            detector.detect(batch, batchBoxes);
+            for (auto &boxes : batchBoxes)
+            {
+                nDetections += boxes.size();
+            }
+        }
+        double ms = elapsedMs(t);
+        cout << "batch size " << setw(2) << batchSize << " : " << fixed << setprecision(2) << 1000.0 * nImages / ms
+             << " frames/s (" << ms / nImages << " ms/frame, " << nDetections << " objects)" << endl;
+    }
+}
+REGISTER_BENCHMARK("yolo-batch", "YOLO frames/sec vs. batch size", benchmarkDetectionBatchSize);
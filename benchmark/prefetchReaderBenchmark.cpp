@@ -0,0 +1,63 @@
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+#include "prefetchReader.hpp"
+
+using namespace std;
+
+// time per frame for reading the KITTI sequence synchronously in the loop against the prefetch reader, with and without
+// a simulated per-frame compute time of the consumer, and how often the consumer had to wait for the reader
+static void benchmarkPrefetchReader(const BenchmarkContext &context)
+{
+    string imgPrefix = context.dataPath + "images/KITTI/2011_09_26/image_02/data/000000";
+    string lidarPrefix = context.dataPath + "images/KITTI/2011_09_26/velodyne_points/data/000000";
+    PrefetchReader::ReadFunction read = directoryReader(imgPrefix, ".png", lidarPrefix, ".bin", 4);
+    struct Variant { string name; size_t depth, nThreads; };
+    const Variant variants[] = {{"synchronous", 0, 0}, {"prefetch", 2, 1}, {"prefetch", 4, 2}, {"prefetch", 8, 4}};
+
+    cout << kittiSequenceLength << " KITTI frames (PNG image + Velodyne scan)" << endl;
+    cout << "compute ms | reader      | depth | threads | ms/frame | stalls | ms waited/frame" << endl;
+    for (int computeMs : {0, 20})
+    {
+        for (const Variant &variant : variants)
+        {
+            SensorFrame frame;
+            size_t nStalls = 0;
+            double msWaited = 0.0;
+            double t = (double)cv::getTickCount();
+            if (variant.depth == 0)
+            {
+                for (int i = 0; i < kittiSequenceLength; ++i)
+                {
+                    double tRead = (double)cv::getTickCount();
+                    read(i, frame);
+                    msWaited += elapsedMs(tRead); // the consumer waits for every read
+                    this_thread::sleep_for(chrono::milliseconds(computeMs));
+                }
+                nStalls = kittiSequenceLength;
+            }
+            else
+            {
+                PrefetchReader reader(read, 0, kittiSequenceLength - 1, 1, variant.depth, variant.nThreads);
+                while (reader.next(frame))
+                {
+                    this_thread::sleep_for(chrono::milliseconds(computeMs));
+                }
+                nStalls = reader.stalls();
+                msWaited = 1000.0 * reader.stallTime();
+            }
+            double ms = elapsedMs(t);
+            cout << setw(10) << computeMs << " | " << setw(11) << left << variant.name << right << " | " << setw(5) << variant.depth
+                 << " | " << setw(7) << variant.nThreads << " | " << fixed << setprecision(2) << setw(8) << ms / kittiSequenceLength
+                 << " | " << setw(6) << nStalls << " | " << setw(15) << msWaited / kittiSequenceLength << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("prefetch-reader", "synchronous vs. prefetched reading of the KITTI images and Lidar scans", benchmarkPrefetchReader);
@@ -0,0 +1,127 @@
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "benchmark.hpp"
+#include "camFusion.hpp"
+#include "featurePipeline.hpp"
+#include "objectDetection2D.hpp"
+
+using namespace std;
+
+// feature time saved by detecting keypoints only inside the YOLO boxes, and the resulting change of the camera TTC of
+// the vehicle ahead; the full-frame detection is the reference
+static void benchmarkRoiFeatures(const BenchmarkContext &context)
+{
+    double frameRate = 10.0;
+    cv::Rect egoRoi = syntheticBoxes(1)[0].roi;
+
+    cout << "detecting objects with YOLO ..." << endl;
+    ObjectDetector objectDetector(yoloFile(context, "coco.names"), yoloFile(context, "yolov3.cfg"), yoloFile(context, "yolov3.weights"));
+    vector<cv::Mat> images;
+    vector<vector<BoundingBox>> frameBoxes(kittiSequenceLength);
+    vector<int> egoBoxIdx(kittiSequenceLength, -1); // box with the largest overlap with the lane ahead
+    double imageArea = 0.0, roiArea = 0.0;
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+        objectDetector.detect(img, frameBoxes[i]);
+
+        int maxOverlap = 0;
+        cv::Mat mask = cv::Mat::zeros(img.size(), CV_8UC1);
+        for (size_t b = 0; b < frameBoxes[i].size(); ++b)
+        {
+            int overlap = (frameBoxes[i][b].roi & egoRoi).area();
+            if (overlap > maxOverlap)
+            {
+                maxOverlap = overlap;
+                egoBoxIdx[i] = b;
+            }
+            mask(frameBoxes[i][b].roi & cv::Rect(0, 0, img.cols, img.rows)).setTo(cv::Scalar(255));
+        }
+        imageArea += img.total();
+        roiArea += cv::countNonZero(mask);
+    }
+    cout << "YOLO boxes cover " << fixed << setprecision(1) << 100.0 * roiArea / imageArea << " % of the image on average" << endl;
+
+    struct Combination { DetectorType detector; DescriptorType descriptor; };
+    const Combination combinations[] = {{DetectorType::ShiTomasi, DescriptorType::BRISK}, {DetectorType::FAST, DescriptorType::BRIEF},
+                                        {DetectorType::ORB, DescriptorType::ORB}, {DetectorType::AKAZE, DescriptorType::AKAZE}};
+
+    cout << "detector  | descriptor | features    | ms/frame | keypoints/frame | TTC frames | mean |dTTC| | max. |dTTC| / TTC" << endl;
+    for (const Combination &combination : combinations)
+    {
+        vector<double> ttcFull;
+        for (bool bRoi : {false, true})
+        {
+            FeaturePipelineConfig config(combination.detector, combination.descriptor);
+            config.roi = RoiRestrictionOptions(bRoi);
+            FeaturePipeline pipeline(config);
+
+            vector<double> ttcs;
+            double ms = 0.0;
+            size_t nKeypoints = 0;
+            vector<cv::KeyPoint> kptsPrev;
+            cv::Mat descPrev;
+            cout.setstate(ios_base::failbit); // silence the printouts of the detectors, matcher and TTC
+            for (int i = 0; i < kittiSequenceLength; ++i)
+            {
+                vector<cv::KeyPoint> kptsCurr;
+                cv::Mat descCurr;
+                double t = (double)cv::getTickCount();
+                pipeline.setRegionsOfInterest(frameBoxes[i], images[i].size());
+                pipeline.detect(images[i], kptsCurr);
+                pipeline.describe(images[i], kptsCurr, descCurr);
+                ms += elapsedMs(t);
+                nKeypoints += kptsCurr.size();
+
+                if (i > 0)
+                {
+                    double ttc = NAN;
+                    if (egoBoxIdx[i] >= 0)
+                    {
+                        vector<cv::DMatch> matches;
+                        pipeline.match(descPrev, descCurr, matches);
+                        BoundingBox box = frameBoxes[i][egoBoxIdx[i]];
+                        clusterKptMatchesWithROI(box, kptsPrev, kptsCurr, matches);
+                        computeTTCCamera(kptsPrev, kptsCurr, box.kptMatches, frameRate, ttc, CameraTTCOptions());
+                    }
+                    ttcs.push_back(ttc);
+                }
+                kptsPrev.swap(kptsCurr);
+                descPrev = descCurr;
+            }
+            cout.clear();
+            if (!bRoi)
+            {
+                ttcFull = ttcs;
+            }
+
+            // deviation from the full-frame TTC, frames without a valid estimate in both runs are skipped
+            double sumDiff = 0.0, maxRelDiff = 0.0;
+            int nValid = 0;
+            for (size_t i = 0; i < ttcs.size(); ++i)
+            {
+                if (std::isfinite(ttcs[i]) && std::isfinite(ttcFull[i]))
+                {
+                    double diff = fabs(ttcs[i] - ttcFull[i]);
+                    sumDiff += diff;
+                    maxRelDiff = max(maxRelDiff, diff / fabs(ttcFull[i]));
+                    ++nValid;
+                }
+            }
+            cout << setw(9) << left << detectorTypeName(combination.detector) << " | " << setw(10)
+                 << descriptorTypeName(combination.descriptor) << " | " << setw(11) << (bRoi ? "YOLO boxes" : "full frame")
+                 << right << " | " << setprecision(2) << setw(8) << ms / kittiSequenceLength << " | " << setw(15)
+                 << nKeypoints / kittiSequenceLength << " | " << setw(10) << nValid << " | " << setprecision(3) << setw(9)
+                 << sumDiff / max(1, nValid) << " s | " << setprecision(4) << maxRelDiff << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("roi-features", "feature time and camera TTC with keypoints restricted to the YOLO boxes", benchmarkRoiFeatures);
@@ -0,0 +1,125 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+#include "camFusion.hpp"
+#include "roiIndex.hpp"
+
+using namespace std;
+
+// point-in-box test of clusterLidarWithROI as it was before RoiGridIndex, returns the index of the only enclosing box or -1
+static int enclosingBoxReference(const vector<BoundingBox> &boundingBoxes, const cv::Point &pt, float shrinkFactor)
+{
+    int found = -1, nEnclosing = 0;
+    for (size_t i = 0; i < boundingBoxes.size(); ++i)
+    {
+        cv::Rect smallerBox;
+        smallerBox.x = boundingBoxes[i].roi.x + shrinkFactor * boundingBoxes[i].roi.width / 2.0;
+        smallerBox.y = boundingBoxes[i].roi.y + shrinkFactor * boundingBoxes[i].roi.height / 2.0;
+        smallerBox.width = boundingBoxes[i].roi.width * (1 - shrinkFactor);
+        smallerBox.height = boundingBoxes[i].roi.height * (1 - shrinkFactor);
+        if (smallerBox.contains(pt))
+        {
+            found = i;
+            ++nEnclosing;
+        }
+    }
+    return nEnclosing == 1 ? found : -1;
+}
+
+// point-in-box association of Lidar points and keypoint matches for an increasing no. of bounding boxes
+static void benchmarkRoiIndex(const BenchmarkContext &context)
+{
+    cv::Mat P_rect_00, R_rect_00, RT;
+    loadKittiCalibration(P_rect_00, R_rect_00, RT);
+    LidarProjector projector(P_rect_00, R_rect_00, RT);
+    float shrinkFactor = 0.10;
+    cv::Size imgSize(1242, 375);
+
+    // image positions of all points of the first scans which lie in front of the camera
+    vector<cv::Point> pixels;
+    LidarProjection projection;
+    for (int i = 0; i < kittiSequenceLength; i += 10)
+    {
+        LidarCloud scan;
+        loadLidarFromFile(scan, kittiLidarFile(context, i));
+        projector.project(scan, projection);
+        for (size_t j = 0; j < projection.size(); ++j)
+        {
+            if (projection.valid[j])
+            {
+                pixels.push_back(cv::Point(projection.u[j], projection.v[j]));
+            }
+        }
+    }
+
+    // keypoint matches spread over the image, moving slightly between the frames
+    int nMatches = 2000;
+    cv::RNG rng(7);
+    DataFrame prevFrame, currFrame;
+    vector<cv::DMatch> matches;
+    for (int i = 0; i < nMatches; ++i)
+    {
+        cv::Point2f pt(rng.uniform(0.0f, (float)imgSize.width), rng.uniform(0.0f, (float)imgSize.height));
+        cv::Point2f shift(rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f));
+        prevFrame.keypoints.push_back(cv::KeyPoint(pt, 7.0f));
+        currFrame.keypoints.push_back(cv::KeyPoint(pt + shift, 7.0f));
+        matches.push_back(cv::DMatch(i, i, 0.0f));
+    }
+
+    cout << pixels.size() << " projected Lidar points, " << nMatches << " keypoint matches" << endl;
+    cout << "boxes | Lidar reference   index | kptMatches reference   index | identical" << endl;
+    int boxCounts[] = {5, 10, 25, 50, 100};
+    for (int nBoxes : boxCounts)
+    {
+        vector<BoundingBox> boxes = syntheticBoxes(nBoxes, imgSize);
+        bool bIdentical = true;
+
+        // Lidar points
+        vector<int> refBoxes(pixels.size()), idxBoxes(pixels.size());
+        double t = (double)cv::getTickCount();
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            refBoxes[i] = enclosingBoxReference(boxes, pixels[i], shrinkFactor);
+        }
+        double msLidarRef = elapsedMs(t);
+
+        t = (double)cv::getTickCount();
+        RoiGridIndex shrunkenIndex;
+        shrunkenIndex.build(boxes, shrinkFactor);
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            idxBoxes[i] = shrunkenIndex.queryUnique(pixels[i]);
+        }
+        double msLidarIdx = elapsedMs(t);
+        bIdentical = bIdentical && refBoxes == idxBoxes;
+
+        currFrame.boundingBoxes = boxes;
+        currFrame.roiIndex.build(currFrame.boundingBoxes);
+
+        // keypoint matches per box, the outlier removal is identical in both versions and part of both timings
+        vector<BoundingBox> refKptBoxes = currFrame.boundingBoxes;
+        t = (double)cv::getTickCount();
+        for (auto it = refKptBoxes.begin(); it != refKptBoxes.end(); ++it)
+        {
+            clusterKptMatchesWithROI(*it, prevFrame.keypoints, currFrame.keypoints, matches);
+        }
+        double msKptRef = elapsedMs(t);
+
+        vector<BoundingBox> idxKptBoxes = currFrame.boundingBoxes;
+        t = (double)cv::getTickCount();
+        clusterKptMatchesWithROI(idxKptBoxes, currFrame.roiIndex, prevFrame.keypoints, currFrame.keypoints, matches);
+        double msKptIdx = elapsedMs(t);
+        for (size_t i = 0; i < idxKptBoxes.size(); ++i)
+        {
+            bIdentical = bIdentical && refKptBoxes[i].kptMatches.size() == idxKptBoxes[i].kptMatches.size();
+        }
+
+        cout << setw(5) << nBoxes << " | " << fixed << setprecision(3) << setw(12) << msLidarRef << " ms" << setw(9) << msLidarIdx << " ms"
+             << " | " << setw(15) << msKptRef << " ms" << setw(9) << msKptIdx << " ms"
+             << " | " << (bIdentical ? "yes" : "NO") << endl;
+    }
+}
+REGISTER_BENCHMARK("roi-index", "point-in-box association with and without RoiGridIndex for 5 to 100 boxes (see also box-matching)", benchmarkRoiIndex);
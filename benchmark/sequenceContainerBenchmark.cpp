@@ -0,0 +1,106 @@
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#include "benchmark.hpp"
+#include "lidarData.hpp"
+#include "mappedFile.hpp"
+#include "prefetchReader.hpp"
+#include "sequenceContainer.hpp"
+
+using namespace std;
+
+// read throughput of the KITTI sequence from the directory layout (one PNG and one .bin file per frame) against the
+// sequence container with PNG and with raw images, in sequence and in random order, synchronously and prefetched.
+// Files are in the page cache after the first pass, so the numbers compare decoding and file handling, not the disk.
+static void benchmarkSequenceContainer(const BenchmarkContext &context)
+{
+    string imgPrefix = context.dataPath + "images/KITTI/2011_09_26/image_02/data/000000";
+    string lidarPrefix = context.dataPath + "images/KITTI/2011_09_26/velodyne_points/data/000000";
+    const string containerFiles[] = {"sequenceContainerBenchmark_png.kseq", "sequenceContainerBenchmark_raw.kseq"};
+    cv::Mat P_rect_00, R_rect_00, RT;
+    loadKittiCalibration(P_rect_00, R_rect_00, RT);
+
+    // pack the sequence once per image encoding
+    double directoryMB = 0.0, containerMB[2];
+    for (int e = 0; e < 2; ++e)
+    {
+        double t = (double)cv::getTickCount();
+        SequenceWriter writer(containerFiles[e], e == 0 ? ImageEncoding::PNG : ImageEncoding::Raw);
+        writer.setCalibration(P_rect_00, R_rect_00, RT);
+        vector<uchar> pngBytes;
+        for (int i = 0; i < kittiSequenceLength; ++i)
+        {
+            MappedFile imgFile(kittiImageFile(context, i));
+            LidarScan scan(kittiLidarFile(context, i));
+            pngBytes.assign(imgFile.data(), imgFile.data() + imgFile.size());
+            writer.addEncodedFrame(i, pngBytes, scan.begin(), scan.size());
+            if (e == 0)
+            {
+                directoryMB += (imgFile.size() + scan.size() * sizeof(LidarRecord)) / 1.0e6;
+            }
+        }
+        writer.close();
+        containerMB[e] = writer.bytesWritten() / 1.0e6;
+        cout << "packed " << (e == 0 ? "PNG" : "raw") << " container in " << fixed << setprecision(1) << elapsedMs(t) << " ms" << endl;
+    }
+
+    vector<int> randomOrder(kittiSequenceLength);
+    for (int i = 0; i < kittiSequenceLength; ++i)
+    {
+        randomOrder[i] = i;
+    }
+    shuffle(randomOrder.begin(), randomOrder.end(), mt19937(1));
+
+    {
+        SequenceReader containers[2];
+        for (int e = 0; e < 2; ++e)
+        {
+            containers[e].open(containerFiles[e]);
+        }
+        struct Layout { string name; PrefetchReader::ReadFunction read; double megabytes; };
+        const Layout layouts[] = {{"directory", directoryReader(imgPrefix, ".png", lidarPrefix, ".bin", 4), directoryMB},
+                                  {"container PNG", containers[0].readFunction(), containerMB[0]},
+                                  {"container raw", containers[1].readFunction(), containerMB[1]}};
+        const char *accessNames[] = {"sequential", "random", "prefetch"};
+
+        cout << kittiSequenceLength << " KITTI frames (image + Velodyne scan), prefetch with depth 4 and 2 threads" << endl;
+        cout << "layout        | size MB | access     | ms/frame |   MB/s" << endl;
+        for (const Layout &layout : layouts)
+        {
+            for (int access = 0; access < 3; ++access)
+            {
+                SensorFrame frame;
+                double t = (double)cv::getTickCount();
+                if (access < 2)
+                {
+                    for (int i = 0; i < kittiSequenceLength; ++i)
+                    {
+                        layout.read(access == 0 ? i : randomOrder[i], frame);
+                    }
+                }
+                else
+                { // as in the tracking application
+                    PrefetchReader reader(layout.read, 0, kittiSequenceLength - 1, 1, 4, 2);
+                    while (reader.next(frame))
+                    {
+                    }
+                }
+                double ms = elapsedMs(t);
+                cout << setw(13) << left << layout.name << right << " | " << fixed << setprecision(1) << setw(7) << layout.megabytes
+                     << " | " << setw(10) << left << accessNames[access] << right << " | " << setprecision(2) << setw(8)
+                     << ms / kittiSequenceLength << " | " << setprecision(1) << setw(6) << layout.megabytes / (ms / 1000.0) << endl;
+            }
+        }
+    } // the containers are unmapped before their files are removed
+
+    for (int e = 0; e < 2; ++e)
+    {
+        remove(containerFiles[e].c_str());
+    }
+}
+REGISTER_BENCHMARK("sequence-container", "read throughput of the KITTI sequence from loose files vs. a single container file", benchmarkSequenceContainer);
@@ -0,0 +1,77 @@
+
+#include <iostream>
+#include <iomanip>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "benchmark.hpp"
+#include "featurePipeline.hpp"
+
+using namespace std;
+
+// scaling of the tiled keypoint detection with the no. of threads, compared with detection on the whole image
+static void benchmarkTiledDetection(const BenchmarkContext &context)
+{
+    int nFrames = 20;
+    int tilesX = 8, tilesY = 2; // enough tiles to keep 16 threads busy
+    vector<cv::Mat> images;
+    for (int i = 0; i < nFrames; ++i)
+    {
+        cv::Mat img = cv::imread(kittiImageFile(context, i)), imgGray;
+        cv::cvtColor(img, imgGray, cv::COLOR_BGR2GRAY);
+        images.push_back(imgGray);
+    }
+
+    const DetectorType detectors[] = {DetectorType::FAST, DetectorType::ORB, DetectorType::ShiTomasi};
+    const size_t threadCounts[] = {1, 2, 4, 8, 12, 16};
+
+    cout << nFrames << " KITTI frames, " << tilesX << " x " << tilesY << " tiles, " << thread::hardware_concurrency()
+         << " hardware threads" << endl;
+    cout << "detector  | threads | ms/frame | speed-up | keypoints/frame" << endl;
+    for (DetectorType detectorType : detectors)
+    {
+        // whole image, as a reference
+        FeaturePipelineConfig untiledConfig(detectorType);
+        FeaturePipeline untiled(untiledConfig);
+        size_t nKeypoints = 0;
+        cout.setstate(ios_base::failbit); // silence the printouts of the detectors
+        double t = (double)cv::getTickCount();
+        for (auto &img : images)
+        {
+            vector<cv::KeyPoint> keypoints;
+            untiled.detect(img, keypoints);
+            nKeypoints += keypoints.size();
+        }
+        double msUntiled = elapsedMs(t) / nFrames;
+        cout.clear();
+        cout << setw(9) << left << detectorTypeName(detectorType) << right << " | " << setw(7) << "untiled" << " | " << fixed
+             << setprecision(2) << setw(8) << msUntiled << " | " << setw(8) << "" << " | " << setw(15) << nKeypoints / nFrames << endl;
+
+        double msSingleThread = 0.0;
+        for (size_t nThreads : threadCounts)
+        {
+            FeaturePipelineConfig config(detectorType);
+            config.tiling = TiledDetectionOptions(tilesX, tilesY, 32, 0, nThreads);
+            FeaturePipeline tiled(config);
+            nKeypoints = 0;
+            cout.setstate(ios_base::failbit);
+            t = (double)cv::getTickCount();
+            for (auto &img : images)
+            {
+                vector<cv::KeyPoint> keypoints;
+                tiled.detect(img, keypoints);
+                nKeypoints += keypoints.size();
+            }
+            double ms = elapsedMs(t) / nFrames;
+            cout.clear();
+            if (nThreads == 1)
+            {
+                msSingleThread = ms;
+            }
+            cout << setw(9) << "" << " | " << setw(7) << nThreads << " | " << setw(8) << ms << " | " << setw(7)
+                 << msSingleThread / ms << "x | " << setw(15) << nKeypoints / nFrames << endl;
+        }
+    }
+}
+REGISTER_BENCHMARK("tiled-detection", "scaling of tiled FAST, ORB and Shi-Tomasi detection over 1 to 16 threads", benchmarkTiledDetection);
@@ -16,15 +16,29 @@
 
 #include "dataStructures.h"
 #include "matching2D.hpp"
+#include "featurePipeline.hpp"
 #include "objectDetection2D.hpp"
 #include "lidarData.hpp"
 #include "camFusion.hpp"
+#include "framePipeline.hpp"
+#include "frameRingBuffer.hpp"
+#include "ttcFilter.hpp"
+#include "trackManager.hpp"
+#include "prefetchReader.hpp"
+#include "sequenceContainer.hpp"
 
 // This include is required to plot ttc vs frames using matplot libraries //
 //#include "matplotlibcpp.h"
 
 using namespace std;
 
+// a single frame travelling through the processing pipeline
+struct FrameJob
+{
+    int fileIndex; // index of the camera image and Lidar scan in the recorded sequence
+    DataFrame frame;
+};
+
 
 /* MAIN PROGRAM */
 int main(int argc, const char *argv[])
@@ -48,35 +62,51 @@ int main(int argc, const char *argv[])
     string yoloClassesFile = yoloBasePath + "coco.names";
     string yoloModelConfiguration = yoloBasePath + "yolov3.cfg";
     string yoloModelWeights = yoloBasePath + "yolov3.weights";
+    float confThreshold = 0.2;
+    float nmsThreshold = 0.4;
+
+    // load the network once, it is reused for all frames of the sequence
+    ObjectDetector objectDetector(yoloClassesFile, yoloModelConfiguration, yoloModelWeights, confThreshold, nmsThreshold);
+
+    // offline mode : collect detectionBatchSize frames and detect objects on all of them with a single forward pass
+    bool bBatchDetection = false;
+    int detectionBatchSize = 4;
 
     // Lidar
     string lidarPrefix = "KITTI/2011_09_26/velodyne_points/data/000000";
     string lidarFileType = ".bin";
 
+    // sequence packed into a single file by pack_sequence (e.g. dataPath + "kitti.kseq"); if set, camera images, Lidar
+    // scans and calibration are read from it instead of the files above
+    string sequenceFile = "";
+    SequenceReader sequence;
+    if (!sequenceFile.empty() && !sequence.open(sequenceFile))
+    {
+        return 1;
+    }
+
     // calibration data for camera and lidar
-    cv::Mat P_rect_00(3,4,cv::DataType<double>::type); // 3x4 projection matrix after rectification
-    cv::Mat R_rect_00(4,4,cv::DataType<double>::type); // 3x3 rectifying rotation to make image planes co-planar
-    cv::Mat RT(4,4,cv::DataType<double>::type); // rotation matrix and translation vector
-    
-    RT.at<double>(0,0) = 7.533745e-03; RT.at<double>(0,1) = -9.999714e-01; RT.at<double>(0,2) = -6.166020e-04; RT.at<double>(0,3) = -4.069766e-03;
-    RT.at<double>(1,0) = 1.480249e-02; RT.at<double>(1,1) = 7.280733e-04; RT.at<double>(1,2) = -9.998902e-01; RT.at<double>(1,3) = -7.631618e-02;
-    RT.at<double>(2,0) = 9.998621e-01; RT.at<double>(2,1) = 7.523790e-03; RT.at<double>(2,2) = 1.480755e-02; RT.at<double>(2,3) = -2.717806e-01;
-    RT.at<double>(3,0) = 0.0; RT.at<double>(3,1) = 0.0; RT.at<double>(3,2) = 0.0; RT.at<double>(3,3) = 1.0;
-    
-    R_rect_00.at<double>(0,0) = 9.999239e-01; R_rect_00.at<double>(0,1) = 9.837760e-03; R_rect_00.at<double>(0,2) = -7.445048e-03; R_rect_00.at<double>(0,3) = 0.0;
-    R_rect_00.at<double>(1,0) = -9.869795e-03; R_rect_00.at<double>(1,1) = 9.999421e-01; R_rect_00.at<double>(1,2) = -4.278459e-03; R_rect_00.at<double>(1,3) = 0.0;
-    R_rect_00.at<double>(2,0) = 7.402527e-03; R_rect_00.at<double>(2,1) = 4.351614e-03; R_rect_00.at<double>(2,2) = 9.999631e-01; R_rect_00.at<double>(2,3) = 0.0;
-    R_rect_00.at<double>(3,0) = 0; R_rect_00.at<double>(3,1) = 0; R_rect_00.at<double>(3,2) = 0; R_rect_00.at<double>(3,3) = 1;
-    
-    P_rect_00.at<double>(0,0) = 7.215377e+02; P_rect_00.at<double>(0,1) = 0.000000e+00; P_rect_00.at<double>(0,2) = 6.095593e+02; P_rect_00.at<double>(0,3) = 0.000000e+00;
-    P_rect_00.at<double>(1,0) = 0.000000e+00; P_rect_00.at<double>(1,1) = 7.215377e+02; P_rect_00.at<double>(1,2) = 1.728540e+02; P_rect_00.at<double>(1,3) = 0.000000e+00;
-    P_rect_00.at<double>(2,0) = 0.000000e+00; P_rect_00.at<double>(2,1) = 0.000000e+00; P_rect_00.at<double>(2,2) = 1.000000e+00; P_rect_00.at<double>(2,3) = 0.000000e+00;    
+    cv::Mat P_rect_00; // 3x4 projection matrix after rectification
+    cv::Mat R_rect_00; // 3x3 rectifying rotation to make image planes co-planar
+    cv::Mat RT; // rotation matrix and translation vector
+    if (!sequence.isOpen() || !sequence.calibration(P_rect_00, R_rect_00, RT))
+    {
+        loadKittiCalibration(P_rect_00, R_rect_00, RT);
+    }
+    LidarProjector lidarProjector(P_rect_00, R_rect_00, RT); // calibration folded into a single 3x4 projection matrix
 
     // misc
     double sensorFrameRate = 10.0 / imgStepWidth; // frames per second for Lidar and camera
-    int dataBufferSize = 2;       // no. of images which are held in memory (ring buffer) at the same time
-    vector<DataFrame> dataBuffer; // list of data frames which are held in memory at the same time
+    const size_t dataBufferSize = 2;       // no. of images which are held in memory (ring buffer) at the same time
+    FrameRingBuffer<DataFrame, dataBufferSize> dataBuffer; // list of data frames which are held in memory at the same time
+    BoundedQueue<DataFrame> recycledFrames(dataBufferSize); // frames evicted from the ring buffer, their buffers are re-used by the loader
     bool bVis = false;            // visualize results, only set true for a step which we want to visualize...
+    BoxMatchMode boxMatchMode = BoxMatchMode::BestPerBox; // BestPerBox, OneToOne (global assignment, no box is matched twice)
+    CameraTTCOptions cameraTTCOptions(CameraTTCMode::Exact); // Exact, Sampled (bounded no. of random keypoint pairs), Streaming (constant memory)
+    LidarDistanceOptions lidarDistanceOptions(LidarDistanceStatistic::FilteredMean); // FilteredMean, TrimmedMean, Median, Percentile
+    TrackManager trackManager; // objects tracked over the frames, sets BoundingBox::trackID
+    TTCFilterBank ttcFilters; // Lidar and camera TTC fused over time, one filter per track
+    int nProcessedFrames = 0;
 
     // --------------------------------- This section contains student data for plotting graphs using Matplotlib --------------------------------- //
     /*
@@ -88,100 +118,138 @@ int main(int argc, const char *argv[])
 
     // ---------------------------------------------- End of dataplot variable definition section ------------------------------------------------ //
 
-    string detectorType = "SHITOMASI";  // SHITOMASI, HARRIS, FAST, BRISK, ORB, AKAZE
-    string descriptorType = "BRISK"; // BRISK, BRIEF, ORB, FREAK, AKAZE
-    
-    /* MAIN LOOP OVER ALL IMAGES */
-    for (size_t imgIndex = 0; imgIndex <= imgEndIndex - imgStartIndex; imgIndex+=imgStepWidth)
+    // detector SHITOMASI, HARRIS, FAST, BRISK, ORB, AKAZE, SIFT; descriptor BRISK, BRIEF, ORB, FREAK, AKAZE, SIFT;
+    // matcher MAT_BF, MAT_FLANN; selector SEL_NN, SEL_KNN. Detector, extractor and matcher are created once for all frames
+    FeaturePipelineConfig featureConfig(DetectorType::ShiTomasi, DescriptorType::BRISK, MatcherType::BruteForce, SelectorType::KNN);
+    featureConfig.tiling = TiledDetectionOptions(1, 1); // e.g. (4, 2, 32, 250) : 8 tiles in parallel with at most 250 keypoints each
+    featureConfig.roi = RoiRestrictionOptions(false); // true : keypoints only inside the (enlarged) YOLO boxes
+    featureConfig.guided = GuidedMatchingOptions(false, 40.0f); // true : only keypoints within 40 pixels are compared
+    featureConfig.klt = KltTrackingOptions(false, 500); // true : optical flow instead of descriptors, re-detect below 500 keypoints
+    FeaturePipeline featurePipeline(featureConfig);
+
+    // pipeline : loader -> detector -> lidar -> features -> matcher/TTC, each stage on its own thread so that successive
+    // frames are processed concurrently; set bPipelined = false when visualizing results, as imshow is not thread-safe
+    bool bPipelined = true;
+    size_t pipelineQueueCapacity = 2; // no. of frames which may wait between two stages before the producer is blocked
+    FramePipeline<FrameJob> pipeline(pipelineQueueCapacity);
+
+    /* LOAD IMAGE INTO BUFFER */
+
+    // camera images and Lidar scans are read and decoded on background threads, up to prefetchDepth frames ahead of
+    // the loader; the stalls of the report show how often the pipeline had to wait for the storage
+    size_t prefetchDepth = 4, prefetchThreads = 2;
+    PrefetchReader reader(sequence.isOpen() ? sequence.readFunction()
+                                            : directoryReader(imgBasePath + imgPrefix, imgFileType, imgBasePath + lidarPrefix, lidarFileType, imgFillWidth),
+                          imgStartIndex, imgEndIndex, imgStepWidth, prefetchDepth, prefetchThreads);
+    SensorFrame sensorFrame; // passes the buffers of recycled frames back to the reader
+
+    auto loadImage = [&](FrameJob &job) -> bool
     {
-        /* LOAD IMAGE INTO BUFFER */
-
-        // assemble filenames for current index
-        ostringstream imgNumber;
-        imgNumber << setfill('0') << setw(imgFillWidth) << imgStartIndex + imgIndex;
-        string imgFullFilename = imgBasePath + imgPrefix + imgNumber.str() + imgFileType;
+        if (!reader.next(sensorFrame))
+        {
+            return false;
+        }
 
-        // load image from file 
-        cv::Mat img = cv::imread(imgFullFilename);
+        // re-use the buffers of a frame which has dropped out of the ring buffer
+        if (recycledFrames.tryPop(job.frame))
+        {
+            job.frame.clear();
+        }
 
-        // push image into data frame buffer
-        DataFrame frame;
-        frame.cameraImg = img;
-        dataBuffer.push_back(frame);
+        // take over image and Lidar scan of the prefetched frame
+        job.fileIndex = sensorFrame.index;
+        swap(job.frame.cameraImg, sensorFrame.cameraImg);
+        swap(job.frame.lidarPoints, sensorFrame.lidarPoints);
+        job.frame.imageCache.reset(job.frame.cameraImg); // derived images are built by the stages which need them
 
         //cout << "#1 : LOAD IMAGE INTO BUFFER done" << endl;
+        return true;
+    };
 
 
-        /* DETECT & CLASSIFY OBJECTS */
-
-        float confThreshold = 0.2;
-        float nmsThreshold = 0.4;
-        //this function performs the yolo based object detection
-        detectObjects((dataBuffer.end() - 1)->cameraImg, (dataBuffer.end() - 1)->boundingBoxes, confThreshold, nmsThreshold,
-                      yoloBasePath, yoloClassesFile, yoloModelConfiguration, yoloModelWeights, bVis);
+    /* DETECT & CLASSIFY OBJECTS */
 
-        //cout << "#2 : DETECT & CLASSIFY OBJECTS done" << endl;
+    if (bBatchDetection)
+    {
+        pipeline.addBatchStage("detector", detectionBatchSize, [&](vector<FrameJob> &jobs)
+        {
+            vector<cv::Mat> imgs;
+            vector<vector<BoundingBox>> boxes;
+            for (auto it = jobs.begin(); it != jobs.end(); ++it)
+            {
+                imgs.push_back(it->frame.cameraImg);
+            }
+            objectDetector.detect(imgs, boxes);
+            for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                jobs[i].frame.boundingBoxes.swap(boxes[i]);
+            }
+        });
+    }
+    else
+    {
+        pipeline.addStage("detector", [&](FrameJob &job)
+        {
+            //this function performs the yolo based object detection
+            objectDetector.detect(job.frame.cameraImg, job.frame.boundingBoxes, false);
 
+            //cout << "#2 : DETECT & CLASSIFY OBJECTS done" << endl;
+        });
+    }
 
-        /* CROP LIDAR POINTS */
 
-        // load 3D Lidar points from file
-        string lidarFullFilename = imgBasePath + lidarPrefix + imgNumber.str() + lidarFileType;
-        std::vector<LidarPoint> lidarPoints;
-        loadLidarFromFile(lidarPoints, lidarFullFilename);
+    /* CROP LIDAR POINTS */
 
+    pipeline.addStage("lidar", [&](FrameJob &job)
+    {
         // remove Lidar points based on distance properties
         float minZ = -1.5, maxZ = -0.9, minX = 2.0, maxX = 20.0, maxY = 2.0, minR = 0.1; // focus on ego lane, minR is reflectivity
-        cropLidarPoints(lidarPoints, minX, maxX, maxY, minZ, maxZ, minR);
-    
-        (dataBuffer.end() - 1)->lidarPoints = lidarPoints;
+        cropLidarPoints(job.frame.lidarPoints, minX, maxX, maxY, minZ, maxZ, minR);
 
         //cout << "#3 : CROP LIDAR POINTS done" << endl;
 
 
         /* CLUSTER LIDAR POINT CLOUD */
 
-        // associate Lidar points with camera-based ROI
+        // detection is done, index the ROIs once for all point-in-box tests of this frame
         float shrinkFactor = 0.10; // shrinks each bounding box by the given percentage to avoid 3D object merging at the edges of an ROI, reducing it by 10%
-        clusterLidarWithROI((dataBuffer.end()-1)->boundingBoxes, (dataBuffer.end() - 1)->lidarPoints, shrinkFactor, P_rect_00, R_rect_00, RT);
+        job.frame.roiIndex.build(job.frame.boundingBoxes);
+        job.frame.lidarRoiIndex.build(job.frame.boundingBoxes, shrinkFactor);
+
+        // associate Lidar points with camera-based ROI
+        clusterLidarWithROI(job.frame.boundingBoxes, job.frame.lidarPoints, job.frame.lidarRoiIndex, lidarProjector);
 
         // Visualize 3D objects
-        bVis = false;
+        bool bVis = false;
         if(bVis)
         {
-            show3DObjects((dataBuffer.end()-1)->boundingBoxes, cv::Size(4.0, 20.0), cv::Size(2000, 2000), true);
+            show3DObjects(job.frame.boundingBoxes, cv::Size(4.0, 20.0), cv::Size(2000, 2000), true);
         }
-        bVis = false;
 
         //cout << "#4 : CLUSTER LIDAR POINT CLOUD done" << endl;
+    });
         
-        
-        // REMOVE THIS LINE BEFORE PROCEEDING WITH THE FINAL PROJECT
-        // continue; // skips directly to the next image without processing what comes beneath
 
-        /* DETECT IMAGE KEYPOINTS */
+    /* DETECT IMAGE KEYPOINTS */
 
-        // convert current image to grayscale
-        cv::Mat imgGray;
-        cv::cvtColor((dataBuffer.end()-1)->cameraImg, imgGray, cv::COLOR_BGR2GRAY);
+    pipeline.addStage("features", [&](FrameJob &job)
+    {
+        // grayscale image, converted once per frame into the re-used buffer of the frame's image cache
+        const cv::Mat &imgGray = job.frame.imageCache.gray();
 
         // extract 2D keypoints from current image
-        vector<cv::KeyPoint> keypoints; // create empty feature list for current image        
+        vector<cv::KeyPoint> &keypoints = job.frame.keypoints; // feature list of current image, empty but with the capacity of a recycled frame
 
-        if (detectorType.compare("SHITOMASI") == 0)
-        {
-            detKeypointsShiTomasi(keypoints, imgGray, false);
-        }
-        // implemented other detectors //
-		// Gaurav Borgaonkar keypoint detectors included
-		else if (detectorType.compare("HARRIS") == 0)
-        {
-            detKeypointsHarris(keypoints, imgGray, false);
-        }
-        else        //Modern detectors FAST, BRISK, ORB, AKAZE, SIFT //
+        featurePipeline.setRegionsOfInterest(job.frame.boundingBoxes, imgGray.size());
+        if (featureConfig.klt.enabled)
         {
-            detKeypointsModern(keypoints, imgGray, detectorType, false);
+            // keypoints of the previous frame followed by optical flow, the matches to them replace descriptor matching;
+            // this stage sees the frames in sequence order
+            featurePipeline.track(job.frame.imageCache, keypoints, job.frame.kptMatches, false);
+            job.frame.descriptors.release();
+            return;
         }
+        featurePipeline.detect(imgGray, keypoints, false);
 
         // optional : limit number of keypoints (helpful for debugging and learning)
         bool bLimitKpts = false;
@@ -189,7 +257,7 @@ int main(int argc, const char *argv[])
         {
             int maxKeypoints = 50;
 
-            if (detectorType.compare("SHITOMASI") == 0)
+            if (featureConfig.detector == DetectorType::ShiTomasi)
             { // there is no response info, so keep the first 50 as they are sorted in descending quality order
                 keypoints.erase(keypoints.begin() + maxKeypoints, keypoints.end());
             }
@@ -197,40 +265,59 @@ int main(int argc, const char *argv[])
             cout << " NOTE: Keypoints have been limited!" << endl;
         }
 
-        // push keypoints and descriptor for current frame to end of data buffer
-        (dataBuffer.end() - 1)->keypoints = keypoints;
-
         //cout << "#5 : DETECT KEYPOINTS done" << endl;
 
 
         /* EXTRACT KEYPOINT DESCRIPTORS */
 
-        cv::Mat descriptors;
-        
-        descKeypoints((dataBuffer.end() - 1)->keypoints, (dataBuffer.end() - 1)->cameraImg, descriptors, descriptorType);
-
-        // push descriptors for current frame to end of data buffer
-        (dataBuffer.end() - 1)->descriptors = descriptors;
+        // descriptors are written into the buffer of the frame, which is re-used if it has the right size
+        // the extractors would convert the colour image to grayscale once more
+        featurePipeline.describe(imgGray, job.frame.keypoints, job.frame.descriptors);
 
         //cout << "#6 : EXTRACT DESCRIPTORS done" << endl;
+    });
+
 
+    /* MATCH KEYPOINTS AND COMPUTE TTC, frames arrive here in sequence order */
+
+    auto matchAndComputeTTC = [&](FrameJob &job)
+    {
+        // push the fully processed frame into data frame buffer and hand the evicted frame back to the loader
+        dataBuffer.push(job.frame);
+        recycledFrames.tryPush(job.frame);
+
+        double timestamp = nProcessedFrames++ / sensorFrameRate; // [s] since the first frame
+
+        if (dataBuffer.size() == 1) // objects in the first frame start new tracks
+        {
+            trackManager.update(map<int, int>(), nullptr, dataBuffer.curr());
+        }
 
         if (dataBuffer.size() > 1) // wait until at least two images have been processed
         {
 
             /* MATCH KEYPOINT DESCRIPTORS */
 
-            vector<cv::DMatch> matches;
-            string matcherType = "MAT_BF";        // MAT_BF, MAT_FLANN
-            //string descriptorType = "DES_BINARY"; // DES_BINARY, DES_HOG
-            string selectorType = "SEL_KNN";       // SEL_NN, SEL_KNN
+            // keypoints on tracked objects are expected to move on like their box did in the last frames
+            vector<cv::Point2f> predictedShift;
+            if (featureConfig.guided.enabled && featureConfig.guided.bPredictMotion)
+            {
+                trackManager.predictKeypointShift(dataBuffer.prev(), predictedShift);
+            }
 
-            matchDescriptors((dataBuffer.end() - 2)->keypoints, (dataBuffer.end() - 1)->keypoints,
-                             (dataBuffer.end() - 2)->descriptors, (dataBuffer.end() - 1)->descriptors,
-                             matches, descriptorType, matcherType, selectorType);
+            vector<cv::DMatch> matches;
+            if (featureConfig.klt.enabled)
+            {
+                matches = dataBuffer.curr().kptMatches; // from the optical flow in the features stage
+            }
+            else
+            {
+                featurePipeline.match(dataBuffer.prev().keypoints, dataBuffer.curr().keypoints, dataBuffer.prev().descriptors,
+                                      dataBuffer.curr().descriptors, matches, predictedShift);
+            }
 
             // store matches in current data frame
-            (dataBuffer.end() - 1)->kptMatches = matches;
+            dataBuffer.curr().kptMatches = matches;
 
             //cout << "#7 : MATCH KEYPOINT DESCRIPTORS done" << endl;
 
@@ -240,11 +327,16 @@ int main(int argc, const char *argv[])
             //// STUDENT ASSIGNMENT
             //// TASK FP.1 -> match list of 3D objects (vector<BoundingBox>) between current and previous frame (implement ->matchBoundingBoxes)
             map<int, int> bbBestMatches;
-            matchBoundingBoxes(matches, bbBestMatches, *(dataBuffer.end()-2), *(dataBuffer.end()-1)); // associate bounding boxes between current and previous frame using keypoint matches
+            matchBoundingBoxes(matches, bbBestMatches, dataBuffer.prev(), dataBuffer.curr(), boxMatchMode); // associate bounding boxes between current and previous frame using keypoint matches
             //// EOF STUDENT ASSIGNMENT
 
             // store matches in current data frame
-            (dataBuffer.end()-1)->bbMatches = bbBestMatches;
+            dataBuffer.curr().bbMatches = bbBestMatches;
+            trackManager.update(bbBestMatches, &dataBuffer.prev(), dataBuffer.curr()); // continue, start and end tracks
+
+            //// TASK FP.3 -> assign enclosed keypoint matches to bounding box (implement -> clusterKptMatchesWithROI)
+            clusterKptMatchesWithROI(dataBuffer.curr().boundingBoxes, dataBuffer.curr().roiIndex, dataBuffer.prev().keypoints,
+                                     dataBuffer.curr().keypoints, dataBuffer.curr().kptMatches);
 
             //cout << "#8 : TRACK 3D OBJECT BOUNDING BOXES done" << endl;
 
@@ -252,26 +344,17 @@ int main(int argc, const char *argv[])
             /* COMPUTE TTC ON OBJECT IN FRONT */
 
 
-            // loop over all BB match pairs
-            for (auto it1 = (dataBuffer.end() - 1)->bbMatches.begin(); it1 != (dataBuffer.end() - 1)->bbMatches.end(); ++it1)
+            // loop over all objects which have been tracked from the previous into the current frame
+            for (auto it1 = dataBuffer.curr().boundingBoxes.begin(); it1 != dataBuffer.curr().boundingBoxes.end(); ++it1)
             {
-                // find bounding boxes associates with current match
-                BoundingBox *prevBB, *currBB;
-                for (auto it2 = (dataBuffer.end() - 1)->boundingBoxes.begin(); it2 != (dataBuffer.end() - 1)->boundingBoxes.end(); ++it2)
-                {
-                    if (it1->second == it2->boxID) // check whether current match partner corresponds to this BB
-                    {
-                        currBB = &(*it2);
-                    }
-                }
-
-                for (auto it2 = (dataBuffer.end() - 2)->boundingBoxes.begin(); it2 != (dataBuffer.end() - 2)->boundingBoxes.end(); ++it2)
+                // find bounding boxes associated with the track of the current box
+                const Track *track = trackManager.find(it1->trackID);
+                if (track == nullptr || track->prevBoxIdx < 0) // track has just been started
                 {
-                    if (it1->first == it2->boxID) // check whether current match partner corresponds to this BB
-                    {
-                        prevBB = &(*it2);
-                    }
+                    continue;
                 }
+                BoundingBox *prevBB = &dataBuffer.prev().boundingBoxes[track->prevBoxIdx];
+                BoundingBox *currBB = &(*it1);
 
                 // We check if both bounding boxes have associated lidar points //
                 // compute TTC for current match                
@@ -280,18 +363,21 @@ int main(int argc, const char *argv[])
                 {
                     //// STUDENT ASSIGNMENT
                     //// TASK FP.2 -> compute time-to-collision based on Lidar data (implement -> computeTTCLidar)
-                    double ttcLidar; 
-                    computeTTCLidar(prevBB->lidarPoints, currBB->lidarPoints, sensorFrameRate, ttcLidar);
+                    double ttcLidar, lidarDistance; 
+                    computeTTCLidar(prevBB->lidarPoints, currBB->lidarPoints, sensorFrameRate, ttcLidar, lidarDistanceOptions, &lidarDistance);
 
                     //// EOF STUDENT ASSIGNMENT
 
                     //// STUDENT ASSIGNMENT
-                    //// TASK FP.3 -> assign enclosed keypoint matches to bounding box (implement -> clusterKptMatchesWithROI)
                     //// TASK FP.4 -> compute time-to-collision based on camera (implement -> computeTTCCamera)
                     double ttcCamera;
-                    clusterKptMatchesWithROI(*currBB, (dataBuffer.end() - 2)->keypoints, (dataBuffer.end() - 1)->keypoints, (dataBuffer.end() - 1)->kptMatches);                    
-                    computeTTCCamera((dataBuffer.end() - 2)->keypoints, (dataBuffer.end() - 1)->keypoints, currBB->kptMatches, sensorFrameRate, ttcCamera);
+                    computeTTCCamera(dataBuffer.prev().keypoints, dataBuffer.curr().keypoints, currBB->kptMatches, sensorFrameRate, ttcCamera, cameraTTCOptions);
                     //// EOF STUDENT ASSIGNMENT
+
+                    // fuse both measurements into the TTC filter of the track
+                    double ttcFiltered = ttcFilters.update(currBB->trackID, timestamp, lidarDistance, ttcCamera);
+                    cout << "TTC track " << currBB->trackID << " : Lidar = " << ttcLidar << ", camera = " << ttcCamera
+                         << ", filtered = " << ttcFiltered << " seconds." << endl;
                     
                     /*
                     // --------------------------------- Variables required for plotting graphs using Matplotlib --------------------------------- //
@@ -307,12 +393,12 @@ int main(int argc, const char *argv[])
                     bVis = false;
                     if (bVis)
                     {
-                        cv::Mat visImg = (dataBuffer.end() - 1)->cameraImg.clone();
-                        showLidarImgOverlay(visImg, currBB->lidarPoints, P_rect_00, R_rect_00, RT, &visImg);
+                        cv::Mat visImg = dataBuffer.curr().cameraImg.clone();
+                        showLidarImgOverlay(visImg, currBB->lidarPoints, lidarProjector, &visImg);
                         cv::rectangle(visImg, cv::Point(currBB->roi.x, currBB->roi.y), cv::Point(currBB->roi.x + currBB->roi.width, currBB->roi.y + currBB->roi.height), cv::Scalar(0, 255, 0), 2);
                         
                         char str[200];
-                        sprintf(str, "TTC Lidar : %f s, TTC Camera : %f s", ttcLidar, ttcCamera);
+                        sprintf(str, "Track %d : TTC Lidar : %f s, TTC Camera : %f s, filtered : %f s", currBB->trackID, ttcLidar, ttcCamera, ttcFiltered);
                         putText(visImg, str, cv::Point2f(80, 50), cv::FONT_HERSHEY_PLAIN, 2, cv::Scalar(0,0,255));
 
                         string windowName = "Final Results : TTC";
@@ -326,11 +412,23 @@ int main(int argc, const char *argv[])
                     // Plot line from given x and y data. Color is selected automatically.
 
                 } // eof TTC computation
-            } // eof loop over all BB matches            
+            } // eof loop over all tracked objects
+        }
 
+        // filters of ended tracks and of tracks without recent Lidar and camera measurements are dropped
+        for (auto it = trackManager.endedTracks().begin(); it != trackManager.endedTracks().end(); ++it)
+        {
+            ttcFilters.remove(*it);
         }
+        ttcFilters.removeStaleTracks(timestamp);
+    };
+
+    /* MAIN LOOP OVER ALL IMAGES */
+    pipeline.run("loader", loadImage, "matcher/TTC", matchAndComputeTTC, bPipelined);
 
-    } // eof loop over all images
+    pipeline.printReport();
+    reader.printReport();
+    objectDetector.printTimingReport();
 
     /*
     // From now, next section contains student code for plotting images for performance evaluation with the help of MATPLOTLIB libraries //
@@ -351,12 +449,12 @@ int main(int argc, const char *argv[])
         matplotlibcpp::ylim(0, 20);
 
         // Add graph title and XY axes titles
-        matplotlibcpp::title("TTC vs Frame ("+detectorType+" + "+descriptorType+")");
+        matplotlibcpp::title("TTC vs Frame ("+string(detectorTypeName(featureConfig.detector))+" + "+descriptorTypeName(featureConfig.descriptor)+")");
         matplotlibcpp::xlabel("Frame Number");
         matplotlibcpp::ylabel("TTC (seconds)");
 
         //matplotlibcpp::show();
-        matplotlibcpp::save("/home/gaurav/Desktop/sensor_fusion/SFND_3D_Object_Tracking/plots/"+detectorType+" + "+descriptorType+"_30frames.png");
+        matplotlibcpp::save("/home/gaurav/Desktop/sensor_fusion/SFND_3D_Object_Tracking/plots/"+string(detectorTypeName(featureConfig.detector))+" + "+descriptorTypeName(featureConfig.descriptor)+"_30frames.png");
 
     }
     */
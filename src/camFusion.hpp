@@ -6,16 +6,60 @@
 #include <vector>
 #include <opencv2/core.hpp>
 #include "dataStructures.h"
+#include "lidarProjection.hpp"
+#include "roiIndex.hpp"
 
 
+// shrunkenIndex holds the shrunken ROIs of boundingBoxes, i.e. RoiGridIndex::build(boundingBoxes, shrinkFactor), built
+// once per frame; the overloads taking shrinkFactor build a temporary index on each call
+void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, LidarCloud &lidarPoints, const RoiGridIndex &shrunkenIndex, const LidarProjector &projector);
+void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, LidarCloud &lidarPoints, float shrinkFactor, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT);
 void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, std::vector<LidarPoint> &lidarPoints, float shrinkFactor, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT);
 void clusterKptMatchesWithROI(BoundingBox &boundingBox, std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, std::vector<cv::DMatch> &kptMatches);
-void matchBoundingBoxes(std::vector<cv::DMatch> &matches, std::map<int, int> &bbBestMatches, DataFrame &prevFrame, DataFrame &currFrame);
+void clusterKptMatchesWithROI(std::vector<BoundingBox> &boundingBoxes, const RoiGridIndex &roiIndex, std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, std::vector<cv::DMatch> &kptMatches);
+// BestPerBox picks the current box with the most shared keypoint matches for every previous box independently,
+// OneToOne solves a global assignment so that no current box is matched twice
+enum class BoxMatchMode { BestPerBox, OneToOne };
+void matchBoundingBoxes(std::vector<cv::DMatch> &matches, std::map<int, int> &bbBestMatches, DataFrame &prevFrame, DataFrame &currFrame, BoxMatchMode mode=BoxMatchMode::BestPerBox);
 
 void show3DObjects(std::vector<BoundingBox> &boundingBoxes, cv::Size worldSize, cv::Size imageSize, bool bWait=true);
 
+// Exact takes the median distance ratio over all keypoint pairs, Sampled over at most pairBudget random pairs and
+// Streaming estimates the median over all pairs in constant memory
+enum class CameraTTCMode { Exact, Sampled, Streaming };
+struct CameraTTCOptions {
+    CameraTTCMode mode;
+    size_t pairBudget; // max. no. of pairs drawn in Sampled mode
+    unsigned int seed; // random seed of Sampled mode, so that results are reproducible
+
+    CameraTTCOptions(CameraTTCMode mode = CameraTTCMode::Exact, size_t pairBudget = 4000, unsigned int seed = 1) : mode(mode), pairBudget(pairBudget), seed(seed) {}
+};
+
+void computeTTCCamera(const std::vector<cv::KeyPoint> &kptsPrev, const std::vector<cv::KeyPoint> &kptsCurr,
+                      const std::vector<cv::DMatch> &kptMatches, double frameRate, double &TTC, const CameraTTCOptions &options);
 void computeTTCCamera(std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr,
                       std::vector<cv::DMatch> kptMatches, double frameRate, double &TTC, cv::Mat *visImg=nullptr);
+// statistic used to estimate the distance to an object from the x-coordinates of its Lidar points
+enum class LidarDistanceStatistic { FilteredMean, TrimmedMean, Median, Percentile };
+struct LidarDistanceOptions {
+    LidarDistanceStatistic statistic;
+    double outlierTolerance; // FilteredMean : points deviating by this fraction of the mean or more are ignored
+    double trimFraction; // TrimmedMean : fraction of the points dropped at each end
+    double percentile; // Percentile : quantile in [0, 1], a low value gives the closest points ignoring a few outliers
+
+    LidarDistanceOptions(LidarDistanceStatistic statistic = LidarDistanceStatistic::FilteredMean)
+        : statistic(statistic), outlierTolerance(0.03), trimFraction(0.1), percentile(0.1) {}
+};
+
+// distance estimate in O(n) which leaves xs untouched, NaN if xs is empty
+double estimateLidarDistance(const std::vector<float> &xs, const LidarDistanceOptions &options = LidarDistanceOptions());
+
+// currDistance, if given, receives the distance estimate of lidarPointsCurr, e.g. for feeding a TTCFilter
+void computeTTCLidar(const LidarCloud &lidarPointsPrev,
+                     const LidarCloud &lidarPointsCurr, double frameRate, double &TTC, const LidarDistanceOptions &options,
+                     double *currDistance=nullptr);
+void computeTTCLidar(const LidarCloud &lidarPointsPrev,
+                     const LidarCloud &lidarPointsCurr, double frameRate, double &TTC);
 void computeTTCLidar(std::vector<LidarPoint> &lidarPointsPrev,
                      std::vector<LidarPoint> &lidarPointsCurr, double frameRate, double &TTC);                  
 #endif /* camFusion_hpp */
@@ -6,62 +6,61 @@
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include "camFusion.hpp"
+#include "hungarian.hpp"
+#include "streamingQuantile.hpp"
 #include "dataStructures.h"
+#include "lidarData.hpp"
 
 using namespace std;
 
 
 // Create groups of Lidar points whose projection into the camera falls into the same bounding box
-void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, std::vector<LidarPoint> &lidarPoints, float shrinkFactor, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT)
+void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, LidarCloud &lidarPoints, const RoiGridIndex &shrunkenIndex, const LidarProjector &projector)
 {
-    // loop over all Lidar points and associate them to a 2D bounding box
-    cv::Mat X(4, 1, cv::DataType<double>::type);
-    cv::Mat Y(3, 1, cv::DataType<double>::type);
+    // project all Lidar points into the camera at once
+    LidarProjection projection;
+    projector.project(lidarPoints, projection);
 
-    for (auto it1 = lidarPoints.begin(); it1 != lidarPoints.end(); ++it1)
+    // loop over all Lidar points and associate them to a 2D bounding box
+    lidarPoints.boxIDs.assign(lidarPoints.size(), -1);
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
     {
-        // assemble vector for matrix-vector-multiplication
-        X.at<double>(0, 0) = it1->x;
-        X.at<double>(1, 0) = it1->y;
-        X.at<double>(2, 0) = it1->z;
-        X.at<double>(3, 0) = 1;
-
-        // project Lidar point into camera
-        Y = P_rect_xx * R_rect_xx * RT * X;
-        cv::Point pt;
-        pt.x = Y.at<double>(0, 0) / Y.at<double>(0, 2); // pixel coordinates
-        pt.y = Y.at<double>(1, 0) / Y.at<double>(0, 2);
-
-        // creating 3D objects...
-        vector<vector<BoundingBox>::iterator> enclosingBoxes; // pointers to all bounding boxes which enclose the current Lidar point
-        // looping through all the bounding boxes ...
-        for (vector<BoundingBox>::iterator it2 = boundingBoxes.begin(); it2 != boundingBoxes.end(); ++it2)
+        if (!projection.valid[i]) // point is behind the camera
         {
-            // shrink current bounding box slightly to avoid having too many outlier points around the edges
-            cv::Rect smallerBox;
-            smallerBox.x = (*it2).roi.x + shrinkFactor * (*it2).roi.width / 2.0;
-            smallerBox.y = (*it2).roi.y + shrinkFactor * (*it2).roi.height / 2.0;
-            smallerBox.width = (*it2).roi.width * (1 - shrinkFactor);
-            smallerBox.height = (*it2).roi.height * (1 - shrinkFactor);
-
-            // check wether point is within current bounding box
-            if (smallerBox.contains(pt))
-            {
-                enclosingBoxes.push_back(it2);
-            }
-
-        } // eof loop over all bounding boxes
+            continue;
+        }
+        cv::Point pt;
+        pt.x = projection.u[i]; // pixel coordinates
+        pt.y = projection.v[i];
 
-        // check wether point has been enclosed by one or by multiple boxes
-        if (enclosingBoxes.size() == 1)
+        // check wether point is enclosed by exactly one of the shrunken bounding boxes
+        int boxIdx = shrunkenIndex.queryUnique(pt);
+        if (boxIdx >= 0)
         { 
             // add Lidar point to bounding box
-            enclosingBoxes[0]->lidarPoints.push_back(*it1);
+            BoundingBox &box = boundingBoxes[boxIdx];
+            box.lidarPoints.push_back(lidarPoints.x[i], lidarPoints.y[i], lidarPoints.z[i], lidarPoints.r[i]);
+            lidarPoints.boxIDs[i] = box.boxID;
         }
 
     } // eof loop over all Lidar point data
 }
 
+void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, LidarCloud &lidarPoints, float shrinkFactor, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT)
+{
+    // shrink all bounding boxes once to avoid having too many outlier points around the edges
+    RoiGridIndex shrunkenIndex;
+    shrunkenIndex.build(boundingBoxes, shrinkFactor);
+    clusterLidarWithROI(boundingBoxes, lidarPoints, shrunkenIndex, LidarProjector(P_rect_xx, R_rect_xx, RT));
+}
+
+void clusterLidarWithROI(std::vector<BoundingBox> &boundingBoxes, std::vector<LidarPoint> &lidarPoints, float shrinkFactor, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT)
+{
+    LidarCloud lidarCloud;
+    toLidarCloud(lidarPoints, lidarCloud);
+    clusterLidarWithROI(boundingBoxes, lidarCloud, shrinkFactor, P_rect_xx, R_rect_xx, RT);
+}
+
 
 void show3DObjects(std::vector<BoundingBox> &boundingBoxes, cv::Size worldSize, cv::Size imageSize, bool bWait)
 {
@@ -77,11 +76,11 @@ void show3DObjects(std::vector<BoundingBox> &boundingBoxes, cv::Size worldSize,
         // plot Lidar points into top view image
         int top=1e8, left=1e8, bottom=0.0, right=0.0; 
         float xwmin=1e8, ywmin=1e8, ywmax=-1e8;
-        for (auto it2 = it1->lidarPoints.begin(); it2 != it1->lidarPoints.end(); ++it2)
+        for (size_t i = 0; i < it1->lidarPoints.size(); ++i)
         {
             // world coordinates
-            float xw = (*it2).x; // world position in m with x facing forward from sensor
-            float yw = (*it2).y; // world position in m with y facing left from sensor
+            float xw = it1->lidarPoints.x[i]; // world position in m with x facing forward from sensor
+            float yw = it1->lidarPoints.y[i]; // world position in m with y facing left from sensor
             xwmin = xwmin<xw ? xwmin : xw;
             ywmin = ywmin<yw ? ywmin : yw;
             ywmax = ywmax>yw ? ywmax : yw;
@@ -133,23 +132,11 @@ void show3DObjects(std::vector<BoundingBox> &boundingBoxes, cv::Size worldSize,
 
 
 // associate a given bounding box with the keypoints it contains
-void clusterKptMatchesWithROI(BoundingBox &boundingBox, std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, std::vector<cv::DMatch> &kptMatches)
+// Remove outlier matches based on the euclidean distance between them in relation to all the matches in the bounding box.
+static void removeKptMatchOutliers(BoundingBox &boundingBox, std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr)
 {
-    // ...
-    // we check if the current region of interest of bounding box contains the matched keypoints
-    
-    for (auto &match : kptMatches)
-    {
-        const auto &currKeyPoint = kptsCurr[match.trainIdx].pt;
-        if (boundingBox.roi.contains(currKeyPoint))
-        {
-            boundingBox.kptMatches.push_back(match);
-        }
-    }
-
     double sums_of_distances = 0;
 
-    // Remove outlier matches based on the euclidean distance between them in relation to all the matches in the bounding box.
     for (auto &it : boundingBox.kptMatches)
     {
         cv::KeyPoint CurrentKpt = kptsCurr.at(it.trainIdx); //get the keypoint from previous frame
@@ -183,192 +170,258 @@ void clusterKptMatchesWithROI(BoundingBox &boundingBox, std::vector<cv::KeyPoint
     }
 }
 
-
-// Compute time-to-collision (TTC) based on keypoint correspondences in successive images
-void computeTTCCamera(std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, 
-                      std::vector<cv::DMatch> kptMatches, double frameRate, double &TTC, cv::Mat *visImg)
+void clusterKptMatchesWithROI(BoundingBox &boundingBox, std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, std::vector<cv::DMatch> &kptMatches)
 {
     // ...
+    // we check if the current region of interest of bounding box contains the matched keypoints
     
-    double dT = 1.0/frameRate;
-
-    // compute distance ratios between all matched keypoints
-    vector<double> distRatios; // stores the distance ratios for all keypoints between curr. and prev. frame
-    for (auto it1 = kptMatches.begin(); it1 != kptMatches.end() - 1; ++it1)
-    { // outer kpt. loop
-
-        // get current keypoint and its matched partner in the prev. frame
-        cv::KeyPoint kpOuterCurr = kptsCurr.at(it1->trainIdx);
-        cv::KeyPoint kpOuterPrev = kptsPrev.at(it1->queryIdx);
+    for (auto &match : kptMatches)
+    {
+        const auto &currKeyPoint = kptsCurr[match.trainIdx].pt;
+        if (boundingBox.roi.contains(currKeyPoint))
+        {
+            boundingBox.kptMatches.push_back(match);
+        }
+    }
 
-        for (auto it2 = kptMatches.begin() + 1; it2 != kptMatches.end(); ++it2)
-        { // inner kpt.-loop
+    removeKptMatchOutliers(boundingBox, kptsPrev, kptsCurr);
+}
 
-            double minDist = 100.0; // min. required distance
+void clusterKptMatchesWithROI(std::vector<BoundingBox> &boundingBoxes, const RoiGridIndex &roiIndex, std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, std::vector<cv::DMatch> &kptMatches)
+{
+    // distribute all matches to the enclosing boxes in a single pass
+    vector<int> boxIndices;
+    for (auto &match : kptMatches)
+    {
+        boxIndices.clear();
+        roiIndex.query(kptsCurr[match.trainIdx].pt, boxIndices);
+        for (auto it = boxIndices.begin(); it != boxIndices.end(); ++it)
+        {
+            boundingBoxes[*it].kptMatches.push_back(match);
+        }
+    }
 
-            // get next keypoint and its matched partner in the prev. frame
-            cv::KeyPoint kpInnerCurr = kptsCurr.at(it2->trainIdx);
-            cv::KeyPoint kpInnerPrev = kptsPrev.at(it2->queryIdx);
+    for (auto it = boundingBoxes.begin(); it != boundingBoxes.end(); ++it)
+    {
+        removeKptMatchOutliers(*it, kptsPrev, kptsCurr);
+    }
+}
 
-            // compute distances and distance ratios
-            double distCurr = cv::norm(kpOuterCurr.pt - kpInnerCurr.pt);
-            double distPrev = cv::norm(kpOuterPrev.pt - kpInnerPrev.pt);
 
-            if (distPrev > std::numeric_limits<double>::epsilon() && distCurr >= minDist)
-            { // avoid division by zero
+// median of the given values, partially reorders them
+static double medianOf(std::vector<double> &values)
+{
+    size_t medianIndex = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + medianIndex, values.end());
+    double median = values[medianIndex];
+    if (values.size() % 2 == 0)
+    {
+        // the lower middle value is the largest one in front of the upper middle value
+        median = (*std::max_element(values.begin(), values.begin() + medianIndex) + median) / 2.0;
+    }
+    return median;
+}
 
-                double distRatio = distCurr / distPrev;
-                distRatios.push_back(distRatio);
-            }
-        } // eof inner loop over all matched kpts
-    }     // eof outer loop over all matched kpts
+// Compute time-to-collision (TTC) based on keypoint correspondences in successive images
+void computeTTCCamera(const std::vector<cv::KeyPoint> &kptsPrev, const std::vector<cv::KeyPoint> &kptsCurr,
+                      const std::vector<cv::DMatch> &kptMatches, double frameRate, double &TTC, const CameraTTCOptions &options)
+{
+    double dT = 1.0/frameRate;
+    double minDist = 100.0; // min. required distance
 
-    // only continue if list of distance ratios is not empty
-    if (distRatios.size() == 0)
+    if (kptMatches.size() < 2)
     {
         TTC = NAN;
         return;
     }
 
-    // calculate median value index
-    std::sort(distRatios.begin(), distRatios.end());
-    int medianIndex = floor(distRatios.size() / 2.0);
-
-    double medDistRatio;
-    
-    if (distRatios.size() % 2 == 0)
+    // gather the matched keypoint positions once instead of copying cv::KeyPoint objects in the pair loops
+    size_t nMatches = kptMatches.size();
+    vector<cv::Point2f> ptsCurr(nMatches), ptsPrev(nMatches);
+    for (size_t i = 0; i < nMatches; ++i)
     {
-        medDistRatio = (distRatios[medianIndex - 1] + distRatios[medianIndex]) / 2.0;
+        ptsCurr[i] = kptsCurr.at(kptMatches[i].trainIdx).pt;
+        ptsPrev[i] = kptsPrev.at(kptMatches[i].queryIdx).pt;
     }
-    else
+
+    // distance ratio of a pair of matched keypoints, false if the pair is too close for a stable ratio
+    auto distRatio = [&](size_t i, size_t j, double &ratio)
+    {
+        double distCurr = cv::norm(ptsCurr[i] - ptsCurr[j]);
+        double distPrev = cv::norm(ptsPrev[i] - ptsPrev[j]);
+        if (distPrev > std::numeric_limits<double>::epsilon() && distCurr >= minDist)
+        { // avoid division by zero
+            ratio = distCurr / distPrev;
+            return true;
+        }
+        return false;
+    };
+
+    double medDistRatio = NAN;
+    double ratio;
+    size_t nPairs = nMatches * (nMatches - 1) / 2; // no. of unordered pairs
+    CameraTTCMode mode = options.mode;
+    if (mode == CameraTTCMode::Sampled && nPairs <= options.pairBudget)
     {
-        medDistRatio = distRatios[medianIndex];
+        mode = CameraTTCMode::Exact; // all pairs fit into the budget
     }
 
-    TTC = -dT / (1 - medDistRatio);
-
-    bool print_ttc_cam = true;
-    if(print_ttc_cam)
+    if (mode == CameraTTCMode::Exact)
     {
-        cout<<"TTC using Camera = "<<TTC<<" seconds."<<endl<<endl;
+        // compute distance ratios between all matched keypoints, same pairs as the original loops (outer from the first
+        // to the second last match, inner from the second to the last match)
+        vector<double> distRatios; // stores the distance ratios for all keypoints between curr. and prev. frame
+        for (size_t i = 0; i + 1 < nMatches; ++i)
+        {
+            for (size_t j = 1; j < nMatches; ++j)
+            {
+                if (distRatio(i, j, ratio))
+                {
+                    distRatios.push_back(ratio);
+                }
+            }
+        }
+        if (!distRatios.empty())
+        {
+            medDistRatio = medianOf(distRatios);
+        }
     }
-    
-}
-
-
-void computeTTCLidar(std::vector<LidarPoint> &lidarPointsPrev,
-                     std::vector<LidarPoint> &lidarPointsCurr, double frameRate, double &TTC)
-{
-    // ...
-    double dT = 1.0/frameRate;  //time between two frames, here equal to framerate
-    double minXPrev = 1e9;  //initializing to high values//
-    double minXCurr = 1e9;
-
-    //apply filter to remove outliers from noise/erroneous measurements
-    
-    // step 1. We first remove the points with y coordinate outside +ve or -ve 2.0 and with reflectivity < 0.1.
-    /*
-    for(auto pt_prev = lidarPointsPrev.begin(); pt_prev<lidarPointsPrev.end(); ++pt_prev)
+    else if (mode == CameraTTCMode::Sampled)
     {
-        if(fabs(pt_prev->y) >= 2.0 || (pt_prev->r < 0.1))        // here lanewidth = 4.0, hence removing any points beyond y = 2.0 or -2.0
+        // median over a bounded no. of randomly drawn pairs
+        cv::RNG rng(options.seed);
+        vector<double> distRatios;
+        distRatios.reserve(options.pairBudget);
+        for (size_t k = 0; k < options.pairBudget; ++k)
         {
-            lidarPointsPrev.erase(pt_prev);
+            size_t i = rng.uniform(0, (int)nMatches), j = rng.uniform(0, (int)nMatches - 1);
+            j += (j >= i); // j != i
+            if (distRatio(i, j, ratio))
+            {
+                distRatios.push_back(ratio);
+            }
+        }
+        if (!distRatios.empty())
+        {
+            medDistRatio = medianOf(distRatios);
         }
     }
-    
-    for(auto pt_curr = lidarPointsCurr.begin(); pt_curr<lidarPointsCurr.end(); ++pt_curr)
+    else
     {
-        if(fabs(pt_curr->y) >= 2.0 || (pt_curr->r < 0.1))        // here lanewidth = 4.0, hence removing any points beyond y = 2.0 or -2.0
+        // streaming median over all unordered pairs in constant memory
+        StreamingQuantile median(0.5);
+        for (size_t i = 0; i + 1 < nMatches; ++i)
         {
-            lidarPointsCurr.erase(pt_curr);
+            for (size_t j = i + 1; j < nMatches; ++j)
+            {
+                if (distRatio(i, j, ratio))
+                {
+                    median.add(ratio);
+                }
+            }
         }
+        medDistRatio = median.value();
     }
-    */
-    
-    // display number of filtered points //
-
-    //cout<<"Filtered Lidar Points in 1st step previous frame = "<<lidarPointsPrev.size()<<endl;
-    //cout<<"Filtered Lidar Points in 1st step current frame = "<<lidarPointsCurr.size()<<endl;
-
-    // step 2. we now add the x coordinates of all filtered points to calculate mean in the next step
-    double x_total_prev = 0;
-    double x_total_curr = 0;
 
-    for (auto it = lidarPointsPrev.begin(); it != lidarPointsPrev.end(); ++it)
+    // only continue if list of distance ratios is not empty
+    if (std::isnan(medDistRatio))
     {
-        //cout<<"x = "<<it->x<<", y = "<<it->y<<", z = "<<it->z<<endl;
-        x_total_prev = x_total_prev + it->x;
+        TTC = NAN;
+        return;
     }
-    for (auto it = lidarPointsCurr.begin(); it != lidarPointsCurr.end(); ++it)
+
+    TTC = -dT / (1 - medDistRatio);
+
+    bool print_ttc_cam = true;
+    if(print_ttc_cam)
     {
-        x_total_curr = x_total_curr + it->x;
+        cout<<"TTC using Camera = "<<TTC<<" seconds."<<endl<<endl;
     }
+}
 
-    // step 3. we calculate the mean x coordinate of filtered points
-    
-    double x_mean_prev = x_total_prev/lidarPointsPrev.size();
-    //cout<<"x mean = "<<x_mean_prev<<endl;
-    double x_mean_curr = x_total_curr/lidarPointsCurr.size();
+void computeTTCCamera(std::vector<cv::KeyPoint> &kptsPrev, std::vector<cv::KeyPoint> &kptsCurr, 
+                      std::vector<cv::DMatch> kptMatches, double frameRate, double &TTC, cv::Mat *visImg)
+{
+    computeTTCCamera(kptsPrev, kptsCurr, kptMatches, frameRate, TTC, CameraTTCOptions());
+}
 
-    // step 4. remove points which seem like outliers - REMOVING POINTS WHICH DEVIATE MORE THAN 3% FROM MEAN X COORDINATE VALUE
-    for(auto pt_prev = lidarPointsPrev.begin(); pt_prev<lidarPointsPrev.end(); ++pt_prev)
+
+double estimateLidarDistance(const std::vector<float> &xs, const LidarDistanceOptions &options)
+{
+    if (xs.empty())
     {
-        if(fabs(x_mean_prev - pt_prev->x) >= 0.03*x_mean_prev)
-        {
-            lidarPointsPrev.erase(pt_prev);
-        }
+        return NAN;
     }
-    for(auto pt_curr = lidarPointsCurr.begin(); pt_curr<lidarPointsCurr.end(); ++pt_curr)
+    size_t n = xs.size();
+
+    if (options.statistic == LidarDistanceStatistic::FilteredMean)
     {
-        if(fabs(x_mean_curr - pt_curr->x) >= 0.03*x_mean_curr)
+        // mean of x, then mean of the points which deviate less than outlierTolerance from it (two passes, no erasing)
+        double x_total = 0;
+        for (auto it = xs.begin(); it != xs.end(); ++it)
         {
-            lidarPointsCurr.erase(pt_curr);
+            x_total = x_total + *it;
         }
-    }
+        double x_mean = x_total / n;
 
-    //step 5. Again display number of points
-
-    //cout<<"Filtered Lidar Points in 2nd step previous frame = "<<lidarPointsPrev.size()<<endl;
-    //cout<<"Filtered Lidar Points in 2nd step current frame = "<<lidarPointsCurr.size()<<endl;
-
-    // step 6. again calculate total value of x coordinates
-    double x_total_prev2 = 0;
-    double x_total_curr2 = 0;
-
-    for (auto it = lidarPointsPrev.begin(); it != lidarPointsPrev.end(); ++it)
-    {
-        //cout<<"x = "<<it->x<<", y = "<<it->y<<", z = "<<it->z<<endl;
-        x_total_prev2 = x_total_prev2 + it->x;
+        double x_total2 = 0;
+        size_t nInliers = 0;
+        for (auto it = xs.begin(); it != xs.end(); ++it)
+        {
+            if (fabs(x_mean - *it) < options.outlierTolerance * x_mean)
+            {
+                x_total2 = x_total2 + *it;
+                ++nInliers;
+            }
+        }
+        return nInliers > 0 ? x_total2 / nInliers : x_mean;
     }
 
-    for (auto it = lidarPointsCurr.begin(); it != lidarPointsCurr.end(); ++it)
+    // the remaining statistics select on a copy, so that the caller's points stay untouched
+    vector<float> x(xs);
+    if (options.statistic == LidarDistanceStatistic::TrimmedMean)
     {
-        x_total_curr2 = x_total_curr2 + it->x;
+        // drop the trimFraction smallest and largest values, the selections leave the kept values in [lo, hi)
+        size_t nTrim = min((size_t)(options.trimFraction * n), (n - 1) / 2);
+        size_t lo = nTrim, hi = n - nTrim;
+        if (nTrim > 0)
+        {
+            nth_element(x.begin(), x.begin() + lo, x.end());
+            nth_element(x.begin() + lo, x.begin() + hi - 1, x.end());
+        }
+        double x_total = 0;
+        for (size_t i = lo; i < hi; ++i)
+        {
+            x_total = x_total + x[i];
+        }
+        return x_total / (hi - lo);
     }
 
-    //step 7. now calculate mean again, mean values are updated
+    // median or percentile, the lower of the two middle values is taken for an even no. of points
+    double q = options.statistic == LidarDistanceStatistic::Median ? 0.5 : options.percentile;
+    size_t k = (size_t)(min(max(q, 0.0), 1.0) * (n - 1));
+    nth_element(x.begin(), x.begin() + k, x.end());
+    return x[k];
+}
 
-    x_mean_prev = x_total_prev2/lidarPointsPrev.size();
-    x_mean_curr = x_total_curr2/lidarPointsCurr.size();
 
-    /*
-    for(auto it = lidarPointsPrev.begin(); it != lidarPointsPrev.end(); ++it)
-    {
-        minXPrev = minXPrev >it->x ? it->x : minXPrev;
-    }
-    for (auto it = lidarPointsCurr.begin(); it != lidarPointsCurr.end(); ++it)
-    {
-        minXCurr = minXCurr >it->x ? it->x : minXCurr;
-    }
-    double d0 = minXPrev;
-    double d1 = minXCurr;
-    */
+void computeTTCLidar(const LidarCloud &lidarPointsPrev,
+                     const LidarCloud &lidarPointsCurr, double frameRate, double &TTC, const LidarDistanceOptions &options,
+                     double *currDistance)
+{
+    // ...
+    double dT = 1.0/frameRate;  //time between two frames, here equal to framerate
 
-    double d0 = x_mean_prev;
-    double d1= x_mean_curr;
+    // only the x-coordinates are needed, they are stored contiguously in the Lidar clouds
+    double d0 = estimateLidarDistance(lidarPointsPrev.x, options);
+    double d1 = estimateLidarDistance(lidarPointsCurr.x, options);
 
     // compute TTC from both measurements
     TTC = d0 * dT / (d0 - d1);
+    if (currDistance)
+    {
+        *currDistance = d1;
+    }
 
     bool print_ttc_value = true;
     if(print_ttc_value)
@@ -378,53 +431,102 @@ void computeTTCLidar(std::vector<LidarPoint> &lidarPointsPrev,
 
 }
 
+void computeTTCLidar(const LidarCloud &lidarPointsPrev,
+                     const LidarCloud &lidarPointsCurr, double frameRate, double &TTC)
+{
+    computeTTCLidar(lidarPointsPrev, lidarPointsCurr, frameRate, TTC, LidarDistanceOptions());
+}
+
+void computeTTCLidar(std::vector<LidarPoint> &lidarPointsPrev,
+                     std::vector<LidarPoint> &lidarPointsCurr, double frameRate, double &TTC)
+{
+    LidarCloud lidarCloudPrev, lidarCloudCurr;
+    toLidarCloud(lidarPointsPrev, lidarCloudPrev);
+    toLidarCloud(lidarPointsCurr, lidarCloudCurr);
+    computeTTCLidar(lidarCloudPrev, lidarCloudCurr, frameRate, TTC);
+}
+
 
-void matchBoundingBoxes(std::vector<cv::DMatch> &matches, std::map<int, int> &bbBestMatches, DataFrame &prevFrame, DataFrame &currFrame)
+void matchBoundingBoxes(std::vector<cv::DMatch> &matches, std::map<int, int> &bbBestMatches, DataFrame &prevFrame, DataFrame &currFrame, BoxMatchMode mode)
 {
     // ...
     // Gaurav Borgaonkar Implementation
-    
-   for (auto &prevBox: prevFrame.boundingBoxes)   //iterating through all initial frames
-   {
-       //create an map variable here to store matches for every loop...
-       map<int, int> matched_pairs;
-
-       for(auto &currBox:currFrame.boundingBoxes) //iterating through every current frame
-       {
-           //cout<<"test_run";
-           for(auto &match:matches) //iterating through all keypoint descriptors match pairs
-           {
-               auto &prev_kpt = prevFrame.keypoints[match.queryIdx].pt;     // from opencv documentation, queryidx is used to get the descriptor index
-               auto prevBox_roi = prevBox.roi;
-               if(prevBox_roi.contains(prev_kpt))   //checking if the current box region of interest contains matched keypoint descriptor
-               {
-                   auto &curr_kpt = currFrame.keypoints[match.trainIdx].pt; // trainIdx is opencv match function for train set of descriptors
-                   auto currBox_roi = currBox.roi;
-                   if(currBox_roi.contains(curr_kpt))
-                   {
-                        if(matched_pairs.count(currBox.boxID) == 0)
-                        {
-                            matched_pairs[currBox.boxID] = 1;
-                        }
-                        else
-                        {
-                            matched_pairs[currBox.boxID]++;
-                        }
-                   }
-               }    //end of loop for mat
-           }    //end of matches loop pairs
-       }    //end of current frames loop
-
-        // here we get the best match possible based on maximum number of keypoint matches
-        
-        auto bestMatch = std::max_element(matched_pairs.begin(), matched_pairs.end(), [](const std::pair<int, int> &a1, const std::pair<int, int> &a2) { return a1.second < a2.second; });
-        
-        bbBestMatches[prevBox.boxID] = bestMatch->first;
 
-        //cout << "Bounding box matches: " << prevBox.boxID << " -> " << bestMatch->first << "\n";
+    // use the ROI indices of the frames, they are only built here if the caller has not done so
+    RoiGridIndex prevLocalIndex, currLocalIndex;
+    const RoiGridIndex *prevIndex = &prevFrame.roiIndex, *currIndex = &currFrame.roiIndex;
+    if (prevIndex->size() != prevFrame.boundingBoxes.size())
+    {
+        prevLocalIndex.build(prevFrame.boundingBoxes);
+        prevIndex = &prevLocalIndex;
+    }
+    if (currIndex->size() != currFrame.boundingBoxes.size())
+    {
+        currLocalIndex.build(currFrame.boundingBoxes);
+        currIndex = &currLocalIndex;
+    }
 
-   }
+    // count the keypoint matches for every pair of previous and current box which enclose both of its keypoints
+    size_t nPrev = prevFrame.boundingBoxes.size(), nCurr = currFrame.boundingBoxes.size();
+    vector<int> votes(nPrev * nCurr, 0); // dense vote matrix, row = previous box, column = current box
+    vector<int> prevBoxes, currBoxes;
+    for (auto &match : matches) //iterating through all keypoint descriptors match pairs
+    {
+        prevBoxes.clear();
+        prevIndex->query(prevFrame.keypoints[match.queryIdx].pt, prevBoxes); // from opencv documentation, queryidx is used to get the descriptor index
+        if (prevBoxes.empty())
+        {
+            continue;
+        }
+        currBoxes.clear();
+        currIndex->query(currFrame.keypoints[match.trainIdx].pt, currBoxes); // trainIdx is opencv match function for train set of descriptors
+        for (auto prevIdx : prevBoxes)
+        {
+            for (auto currIdx : currBoxes)
+            {
+                votes[prevIdx * nCurr + currIdx]++;
+            }
+        }
+    }
 
-}
+    if (mode == BoxMatchMode::OneToOne)
+    {
+        // global assignment maximizing the total no. of votes, pairs without any vote are dropped afterwards
+        vector<double> cost(votes.size());
+        for (size_t i = 0; i < votes.size(); ++i)
+        {
+            cost[i] = -votes[i];
+        }
+        vector<int> prevToCurr;
+        solveAssignment(cost, nPrev, nCurr, prevToCurr);
+        for (size_t i = 0; i < nPrev; ++i)
+        {
+            if (prevToCurr[i] >= 0 && votes[i * nCurr + prevToCurr[i]] > 0)
+            {
+                bbBestMatches[prevFrame.boundingBoxes[i].boxID] = currFrame.boundingBoxes[prevToCurr[i]].boxID;
+            }
+        }
+        return;
+    }
 
+    for (size_t i = 0; i < nPrev; ++i)
+    {
+        // here we get the best match possible based on maximum number of keypoint matches, ties go to the smaller boxID
+        int bestIdx = -1, bestVotes = 0;
+        for (size_t j = 0; j < nCurr; ++j)
+        {
+            int v = votes[i * nCurr + j];
+            if (v > bestVotes || (v == bestVotes && v > 0 && currFrame.boundingBoxes[j].boxID < currFrame.boundingBoxes[bestIdx].boxID))
+            {
+                bestIdx = j;
+                bestVotes = v;
+            }
+        }
+
+        if (bestIdx >= 0) // rows without votes have no partner in the current frame
+        {
+            bbBestMatches[prevFrame.boundingBoxes[i].boxID] = currFrame.boundingBoxes[bestIdx].boxID;
+        }
+    }
+}
 
@@ -6,10 +6,35 @@
 #include <map>
 #include <opencv2/core.hpp>
 
+#include "roiIndex.hpp"
+#include "imageCache.hpp"
+
 struct LidarPoint { // single lidar point in space
     double x,y,z,r; // x,y,z in [m], r is point reflectivity
 };
 
+struct LidarCloud { // lidar points as structure of arrays, one contiguous float array per field
+    std::vector<float> x,y,z,r; // x,y,z in [m], r is point reflectivity
+    std::vector<int> boxIDs; // optional, boxID of the bounding box each point has been associated with (-1 for none)
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    bool hasBoxIDs() const { return !x.empty() && boxIDs.size() == x.size(); }
+
+    void clear() { x.clear(); y.clear(); z.clear(); r.clear(); boxIDs.clear(); }
+    void reserve(size_t n) { x.reserve(n); y.reserve(n); z.reserve(n); r.reserve(n); }
+    void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); r.resize(n); }
+
+    void push_back(float px, float py, float pz, float pr) { x.push_back(px); y.push_back(py); z.push_back(pz); r.push_back(pr); }
+    void push_back(const LidarPoint &pt) { push_back((float)pt.x, (float)pt.y, (float)pt.z, (float)pt.r); }
+
+    LidarPoint point(size_t i) const { LidarPoint pt = {x[i], y[i], z[i], r[i]}; return pt; }
+};
+
+struct LidarRecord { // single lidar point as stored in the KITTI Velodyne .bin files
+    float x,y,z,r;
+};
+
 struct BoundingBox { // bounding box around a classified object (contains both 2D and 3D data)
     
     int boxID; // unique identifier for this bounding box
@@ -19,7 +44,7 @@ struct BoundingBox { // bounding box around a classified object (contains both 2
     int classID; // ID based on class file provided to YOLO framework
     double confidence; // classification trust
 
-    std::vector<LidarPoint> lidarPoints; // Lidar 3D points which project into 2D image roi
+    LidarCloud lidarPoints; // Lidar 3D points which project into 2D image roi
     std::vector<cv::KeyPoint> keypoints; // keypoints enclosed by 2D roi
     std::vector<cv::DMatch> kptMatches; // keypoint matches enclosed by 2D roi
 };
@@ -27,14 +52,29 @@ struct BoundingBox { // bounding box around a classified object (contains both 2
 struct DataFrame { // represents the available sensor information at the same time instance
     
     cv::Mat cameraImg; // camera image
+    ImageCache imageCache; // grayscale image and pyramid of cameraImg, built on first use; reset when cameraImg is loaded
     
     std::vector<cv::KeyPoint> keypoints; // 2D keypoints within camera image
     cv::Mat descriptors; // keypoint descriptors
     std::vector<cv::DMatch> kptMatches; // keypoint matches between previous and current frame
-    std::vector<LidarPoint> lidarPoints;
+    LidarCloud lidarPoints; // Lidar 3D points of the current scan
 
     std::vector<BoundingBox> boundingBoxes; // ROI around detected objects in 2D image coordinates
+    RoiGridIndex roiIndex; // grid index over the ROIs of boundingBoxes, rebuilt once the boxes are final
+    RoiGridIndex lidarRoiIndex; // same over the shrunken ROIs which Lidar points are clustered with
     std::map<int,int> bbMatches; // bounding box matches between previous and current frame
+
+    void clear() // empties the frame for re-use, vectors keep their capacity and cv::Mat buffers are kept for being overwritten
+    {
+        keypoints.clear();
+        kptMatches.clear();
+        lidarPoints.clear();
+        boundingBoxes.clear();
+        roiIndex.clear();
+        lidarRoiIndex.clear();
+        bbMatches.clear();
+        imageCache.reset(cv::Mat());
+    }
 };
 
 #endif /* dataStructures_h */
@@ -0,0 +1,466 @@
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <opencv2/xfeatures2d.hpp>
+#include <opencv2/xfeatures2d/nonfree.hpp>
+
+#include "featurePipeline.hpp"
+#include "matching2D.hpp"
+#include "dataStructures.h"
+
+using namespace std;
+
+const char *detectorTypeName(DetectorType type)
+{
+    switch (type)
+    {
+    case DetectorType::ShiTomasi: return "SHITOMASI";
+    case DetectorType::Harris: return "HARRIS";
+    case DetectorType::FAST: return "FAST";
+    case DetectorType::BRISK: return "BRISK";
+    case DetectorType::ORB: return "ORB";
+    case DetectorType::AKAZE: return "AKAZE";
+    case DetectorType::SIFT: return "SIFT";
+    }
+    return "";
+}
+
+const char *descriptorTypeName(DescriptorType type)
+{
+    switch (type)
+    {
+    case DescriptorType::BRISK: return "BRISK";
+    case DescriptorType::BRIEF: return "BRIEF";
+    case DescriptorType::ORB: return "ORB";
+    case DescriptorType::FREAK: return "FREAK";
+    case DescriptorType::AKAZE: return "AKAZE";
+    case DescriptorType::SIFT: return "SIFT";
+    }
+    return "";
+}
+
+const char *matcherTypeName(MatcherType type)
+{
+    return type == MatcherType::FLANN ? "MAT_FLANN" : "MAT_BF";
+}
+
+const char *selectorTypeName(SelectorType type)
+{
+    return type == SelectorType::NN ? "SEL_NN" : "SEL_KNN";
+}
+
+bool parseDetectorType(const string &name, DetectorType &type)
+{
+    const DetectorType types[] = {DetectorType::ShiTomasi, DetectorType::Harris, DetectorType::FAST, DetectorType::BRISK,
+                                  DetectorType::ORB, DetectorType::AKAZE, DetectorType::SIFT};
+    for (DetectorType t : types)
+    {
+        if (name == detectorTypeName(t))
+        {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseDescriptorType(const string &name, DescriptorType &type)
+{
+    const DescriptorType types[] = {DescriptorType::BRISK, DescriptorType::BRIEF, DescriptorType::ORB,
+                                    DescriptorType::FREAK, DescriptorType::AKAZE, DescriptorType::SIFT};
+    for (DescriptorType t : types)
+    {
+        if (name == descriptorTypeName(t))
+        {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseMatcherType(const string &name, MatcherType &type)
+{
+    for (MatcherType t : {MatcherType::BruteForce, MatcherType::FLANN})
+    {
+        if (name == matcherTypeName(t))
+        {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseSelectorType(const string &name, SelectorType &type)
+{
+    for (SelectorType t : {SelectorType::NN, SelectorType::KNN})
+    {
+        if (name == selectorTypeName(t))
+        {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+// same parameters as detKeypointsModern, empty for Shi-Tomasi and Harris
+static cv::Ptr<cv::FeatureDetector> createDetector(DetectorType type)
+{
+    switch (type)
+    {
+    case DetectorType::ShiTomasi:
+    case DetectorType::Harris:
+        break;
+    case DetectorType::FAST: return cv::FastFeatureDetector::create();
+    case DetectorType::BRISK: return cv::BRISK::create();
+    case DetectorType::ORB: return cv::ORB::create();
+    case DetectorType::AKAZE: return cv::AKAZE::create();
+    case DetectorType::SIFT: return cv::xfeatures2d::SIFT::create();
+    }
+    return cv::Ptr<cv::FeatureDetector>();
+}
+
+FeaturePipeline::FeaturePipeline(const FeaturePipelineConfig &config) : cfg(config), nRedetections(0), bRoiActive(false)
+{
+    // same parameters as detKeypointsModern, descKeypoints and matchDescriptors
+    detector = createDetector(cfg.detector);
+
+    if (cfg.tiling.enabled())
+    {
+        // detectors are not guaranteed to be thread-safe, so every tile gets its own instance
+        int nTiles = cfg.tiling.tilesX * cfg.tiling.tilesY;
+        for (int t = 0; t < nTiles; ++t)
+        {
+            if (cfg.detector == DetectorType::ShiTomasi)
+            { // parameters of detKeypointsShiTomasi, without a limit on the no. of corners
+                tileDetectors.push_back(cv::GFTTDetector::create(0, 0.01, 4.0, 4, false, 0.04));
+            }
+            else
+            {
+                tileDetectors.push_back(createDetector(cfg.detector));
+            }
+        }
+        tileKeypoints.resize(nTiles);
+        pool.reset(new ThreadPool(cfg.tiling.nThreads));
+    }
+
+    switch (cfg.descriptor)
+    {
+    case DescriptorType::BRISK: extractor = cv::BRISK::create(30, 3, 1.0f); break;
+    case DescriptorType::BRIEF: extractor = cv::xfeatures2d::BriefDescriptorExtractor::create(); break;
+    case DescriptorType::ORB: extractor = cv::ORB::create(); break;
+    case DescriptorType::FREAK: extractor = cv::xfeatures2d::FREAK::create(); break;
+    case DescriptorType::AKAZE: extractor = cv::AKAZE::create(); break;
+    case DescriptorType::SIFT: extractor = cv::xfeatures2d::SIFT::create(); break;
+    }
+
+    bool bBinary = cfg.descriptor != DescriptorType::SIFT;
+    if ((bBinary || cfg.guided.enabled) && cfg.nMatchThreads > 1)
+    {
+        matchPool.reset(new ThreadPool(cfg.nMatchThreads));
+    }
+    if (cfg.guided.enabled)
+    {
+        double ratio = cfg.selector == SelectorType::KNN ? cfg.minDescDistRatio : numeric_limits<double>::infinity();
+        guidedMatcher.reset(new GuidedMatcher(cfg.guided.searchRadius, ratio, matchPool.get()));
+    }
+    if (cfg.klt.enabled)
+    {
+        kltTracker.reset(new KltTracker(cfg.klt));
+    }
+    if (cfg.matcher == MatcherType::BruteForce && cfg.selector == SelectorType::KNN && bBinary)
+    {
+        // same matches as BFMatcher with NORM_HAMMING, without the lists of k=2 candidates
+        hammingMatcher.reset(new HammingMatcher(cfg.minDescDistRatio, HammingKernel::Auto, matchPool.get()));
+    }
+    else if (cfg.matcher == MatcherType::FLANN && bBinary)
+    {
+        // hashing of the binary descriptors instead of a KD-tree over a float copy of them
+        lshIndex.reset(new LshIndex());
+    }
+    else if (cfg.matcher == MatcherType::BruteForce)
+    {
+        // SIFT descriptors are float vectors, all others are binary strings
+        int normType = cfg.descriptor == DescriptorType::SIFT ? cv::NORM_L2 : cv::NORM_HAMMING;
+        matcher = cv::BFMatcher::create(normType, false);
+    }
+    else
+    {
+        matcher = cv::FlannBasedMatcher::create(); // KD-tree over the float SIFT descriptors
+    }
+}
+
+void FeaturePipeline::setRegionsOfInterest(const vector<BoundingBox> &boxes, cv::Size imgSize)
+{
+    if (!cfg.roi.enabled)
+    {
+        return;
+    }
+
+    cv::Rect image(0, 0, imgSize.width, imgSize.height);
+    roiMask.create(imgSize, CV_8UC1); // keeps its memory between frames of the same size
+    roiMask.setTo(cv::Scalar(0));
+    int left = imgSize.width, top = imgSize.height, right = 0, bottom = 0;
+    for (auto it = boxes.begin(); it != boxes.end(); ++it)
+    {
+        int dx = cfg.roi.margin * it->roi.width, dy = cfg.roi.margin * it->roi.height;
+        cv::Rect enlarged = cv::Rect(it->roi.x - dx, it->roi.y - dy, it->roi.width + 2 * dx, it->roi.height + 2 * dy) & image;
+        if (enlarged.area() > 0)
+        {
+            roiMask(enlarged).setTo(cv::Scalar(255));
+            left = min(left, enlarged.x);
+            top = min(top, enlarged.y);
+            right = max(right, enlarged.x + enlarged.width);
+            bottom = max(bottom, enlarged.y + enlarged.height);
+        }
+    }
+    roiBounds = right > left ? cv::Rect(left, top, right - left, bottom - top) : cv::Rect();
+    bRoiActive = true;
+}
+
+void FeaturePipeline::detectInRegion(const cv::Mat &imgGray, cv::Rect region, const cv::Ptr<cv::FeatureDetector> &regionDetector,
+                                     vector<cv::KeyPoint> &keypoints)
+{
+    cv::Mat regionImg = imgGray(region);
+    cv::Mat regionMask = bRoiActive ? roiMask(region) : cv::Mat();
+    vector<cv::KeyPoint> found;
+    if (regionDetector)
+    {
+        regionDetector->detect(regionImg, found, regionMask);
+    }
+    else if (cfg.detector == DetectorType::ShiTomasi)
+    {
+        detKeypointsShiTomasi(found, regionImg, false);
+    }
+    else
+    {
+        detKeypointsHarris(found, regionImg, false);
+    }
+    if (bRoiActive)
+    { // most detectors apply the mask only after detection, Shi-Tomasi and Harris not at all
+        cv::KeyPointsFilter::runByPixelsMask(found, regionMask);
+    }
+
+    for (auto &kpt : found)
+    {
+        kpt.pt.x += region.x;
+        kpt.pt.y += region.y;
+    }
+    keypoints.insert(keypoints.end(), found.begin(), found.end());
+}
+
+void FeaturePipeline::detect(const cv::Mat &imgGray, vector<cv::KeyPoint> &keypoints, bool bVis)
+{
+    cv::Mat img = imgGray; // shares the pixels, the legacy detector functions take a non-const image
+    if (cfg.tiling.enabled())
+    {
+        detectTiled(img, keypoints);
+    }
+    else if (bRoiActive)
+    {
+        // detect on the part of the image around the boxes only
+        cv::Rect region = cv::Rect(roiBounds.x - cfg.roi.padding, roiBounds.y - cfg.roi.padding, roiBounds.width + 2 * cfg.roi.padding,
+                                   roiBounds.height + 2 * cfg.roi.padding) & cv::Rect(0, 0, img.cols, img.rows);
+        if (roiBounds.area() > 0 && region.area() > 0)
+        {
+            detectInRegion(img, region, detector, keypoints);
+        }
+    }
+    else if (cfg.detector == DetectorType::ShiTomasi)
+    {
+        detKeypointsShiTomasi(keypoints, img, bVis);
+        return;
+    }
+    else if (cfg.detector == DetectorType::Harris)
+    {
+        detKeypointsHarris(keypoints, img, bVis);
+        return;
+    }
+    else if (keypoints.empty())
+    {
+        detector->detect(img, keypoints); // writes into the capacity of a recycled keypoint list
+    }
+    else
+    {
+        vector<cv::KeyPoint> detected;
+        detector->detect(img, detected);
+        keypoints.insert(keypoints.end(), detected.begin(), detected.end());
+    }
+
+    if (bVis)
+    {
+        cv::Mat visImage = img.clone();
+        cv::drawKeypoints(img, keypoints, visImage, cv::Scalar::all(-1), cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
+        string windowName = string(detectorTypeName(cfg.detector)) + " Corner Detector Results";
+        cv::namedWindow(windowName, 6);
+        imshow(windowName, visImage);
+        cv::waitKey(0);
+    }
+}
+
+void FeaturePipeline::detectTiled(const cv::Mat &imgGray, vector<cv::KeyPoint> &keypoints)
+{
+    double t = (double)cv::getTickCount();
+    const TiledDetectionOptions &tiling = cfg.tiling;
+    int nTiles = tiling.tilesX * tiling.tilesY;
+
+    pool->parallelFor(nTiles, [&](size_t tileIdx) {
+        // the core regions of the tiles partition the image, each tile is its core plus the overlap
+        int tx = tileIdx % tiling.tilesX, ty = tileIdx / tiling.tilesX;
+        int x0 = imgGray.cols * tx / tiling.tilesX, x1 = imgGray.cols * (tx + 1) / tiling.tilesX;
+        int y0 = imgGray.rows * ty / tiling.tilesY, y1 = imgGray.rows * (ty + 1) / tiling.tilesY;
+        cv::Rect tile = cv::Rect(x0 - tiling.overlap, y0 - tiling.overlap, x1 - x0 + 2 * tiling.overlap, y1 - y0 + 2 * tiling.overlap) &
+                        cv::Rect(0, 0, imgGray.cols, imgGray.rows);
+
+        vector<cv::KeyPoint> &tileKpts = tileKeypoints[tileIdx];
+        tileKpts.clear();
+        if (bRoiActive && (cv::Rect(x0, y0, x1 - x0, y1 - y0) & roiBounds).area() == 0)
+        {
+            return; // no box in this tile
+        }
+        detectInRegion(imgGray, tile, tileDetectors[tileIdx], tileKpts);
+
+        // keypoints in the overlap belong to the neighbouring tile
+        size_t nKept = 0;
+        for (size_t i = 0; i < tileKpts.size(); ++i)
+        {
+            const cv::KeyPoint &kpt = tileKpts[i];
+            if (kpt.pt.x >= x0 && kpt.pt.x < x1 && kpt.pt.y >= y0 && kpt.pt.y < y1)
+            {
+                tileKpts[nKept++] = kpt;
+            }
+        }
+        tileKpts.resize(nKept);
+
+        if (tiling.maxKeypointsPerTile > 0 && (int)tileKpts.size() > tiling.maxKeypointsPerTile)
+        { // stable, so that equal responses keep the order of the detector
+            stable_sort(tileKpts.begin(), tileKpts.end(),
+                        [](const cv::KeyPoint &a, const cv::KeyPoint &b) { return a.response > b.response; });
+            tileKpts.resize(tiling.maxKeypointsPerTile);
+        }
+    });
+
+    // merged in tile order, so that the result does not depend on the no. of threads
+    size_t nBefore = keypoints.size();
+    for (auto &tileKpts : tileKeypoints)
+    {
+        keypoints.insert(keypoints.end(), tileKpts.begin(), tileKpts.end());
+    }
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    cout << detectorTypeName(cfg.detector) << " detection on " << nTiles << " tiles with n=" << keypoints.size() - nBefore
+         << " keypoints in " << 1000 * t / 1.0 << " ms" << endl;
+}
+
+void FeaturePipeline::describe(const cv::Mat &img, vector<cv::KeyPoint> &keypoints, cv::Mat &descriptors)
+{
+    double t = (double)cv::getTickCount();
+    extractor->compute(img, keypoints, descriptors);
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    cout << descriptorTypeName(cfg.descriptor) << " descriptor extraction in " << 1000 * t / 1.0 << " ms" << endl;
+}
+
+void FeaturePipeline::match(const cv::Mat &descSource, const cv::Mat &descRef, vector<cv::DMatch> &matches)
+{
+    if (descSource.empty() || descRef.empty())
+    { // e.g. a frame without objects when detection is restricted to the bounding boxes
+        cout << "No of matched points = 0" << endl;
+        return;
+    }
+    if (hammingMatcher)
+    {
+        size_t nBefore = matches.size();
+        hammingMatcher->match(descSource, descRef, matches);
+        cout << "No of matched points = " << matches.size() - nBefore << endl;
+        return;
+    }
+
+    size_t nBefore = matches.size();
+    if (lshIndex)
+    {
+        // index over the descriptors of the current frame, queried with those of the previous one
+        double ratio = cfg.selector == SelectorType::KNN ? cfg.minDescDistRatio : numeric_limits<double>::infinity();
+        lshIndex->build(descRef);
+        lshIndex->match(descSource, matches, ratio, matchPool.get());
+    }
+    else if (cfg.selector == SelectorType::NN)
+    {
+        vector<cv::DMatch> best;
+        matcher->match(descSource, descRef, best);
+        matches.insert(matches.end(), best.begin(), best.end());
+    }
+    else
+    {
+        matcher->knnMatch(descSource, descRef, knnMatches, 2);
+        for (auto it = knnMatches.begin(); it != knnMatches.end(); ++it)
+        {
+            if (it->size() > 1 && (*it)[0].distance < cfg.minDescDistRatio * (*it)[1].distance)
+                matches.push_back((*it)[0]);
+        }
+    }
+    cout << "No of matched points = " << matches.size() - nBefore << endl;
+}
+
+void FeaturePipeline::match(const vector<cv::KeyPoint> &kptsSource, const vector<cv::KeyPoint> &kptsRef,
+                            const cv::Mat &descSource, const cv::Mat &descRef, vector<cv::DMatch> &matches,
+                            const vector<cv::Point2f> &predictedShift)
+{
+    if (!guidedMatcher)
+    {
+        match(descSource, descRef, matches);
+        return;
+    }
+
+    size_t nBefore = matches.size();
+    guidedMatcher->match(kptsSource, kptsRef, descSource, descRef, predictedShift, matches);
+    cout << "No of matched points = " << matches.size() - nBefore << " (" << guidedMatcher->meanCandidates()
+         << " candidates per keypoint)" << endl;
+}
+
+void FeaturePipeline::track(const cv::Mat &imgGray, vector<cv::KeyPoint> &keypoints, vector<cv::DMatch> &matches, bool bVis)
+{
+    if (!kltTracker)
+    {
+        throw invalid_argument("FeaturePipeline: track requires the optical flow mode (klt.enabled)");
+    }
+    trackFrame(imgGray, nullptr, keypoints, matches, bVis);
+}
+
+void FeaturePipeline::track(ImageCache &images, vector<cv::KeyPoint> &keypoints, vector<cv::DMatch> &matches, bool bVis)
+{
+    if (!kltTracker)
+    {
+        throw invalid_argument("FeaturePipeline: track requires the optical flow mode (klt.enabled)");
+    }
+    trackFrame(images.gray(), &images.opticalFlowPyramid(cfg.klt.winSize, cfg.klt.maxLevel), keypoints, matches, bVis);
+}
+
+void FeaturePipeline::trackFrame(const cv::Mat &imgGray, const vector<cv::Mat> *pyramid, vector<cv::KeyPoint> &keypoints,
+                                 vector<cv::DMatch> &matches, bool bVis)
+{
+    double t = (double)cv::getTickCount();
+    size_t nBefore = keypoints.size();
+    if (pyramid)
+    {
+        kltTracker->track(*pyramid, keypoints, matches);
+    }
+    else
+    {
+        kltTracker->track(imgGray, keypoints, matches);
+    }
+    size_t nTracked = keypoints.size() - nBefore;
+    if (nTracked < (size_t)cfg.klt.minTracked)
+    {
+        vector<cv::KeyPoint> detected;
+        detect(imgGray, detected, bVis);
+        kltTracker->addKeypoints(detected, keypoints);
+        ++nRedetections;
+    }
+    kltTracker->endFrame(vector<cv::KeyPoint>(keypoints.begin() + nBefore, keypoints.end()));
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    cout << "KLT tracked n=" << nTracked << " keypoints, " << keypoints.size() - nBefore - nTracked << " detected, in "
+         << 1000 * t / 1.0 << " ms" << endl;
+}
@@ -0,0 +1,150 @@
+
+#ifndef featurePipeline_hpp
+#define featurePipeline_hpp
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include "threadPool.hpp"
+#include "hammingMatcher.hpp"
+#include "lshIndex.hpp"
+#include "guidedMatcher.hpp"
+#include "kltTracker.hpp"
+#include "imageCache.hpp"
+
+struct BoundingBox;
+
+enum class DetectorType { ShiTomasi, Harris, FAST, BRISK, ORB, AKAZE, SIFT };
+enum class DescriptorType { BRISK, BRIEF, ORB, FREAK, AKAZE, SIFT };
+enum class MatcherType { BruteForce, FLANN };
+enum class SelectorType { NN, KNN }; // best match or k=2 nearest neighbours with distance ratio test
+
+// names as used on the command line and in the printouts ("SHITOMASI", "BRISK", "MAT_BF", "SEL_KNN", ...)
+const char *detectorTypeName(DetectorType type);
+const char *descriptorTypeName(DescriptorType type);
+const char *matcherTypeName(MatcherType type);
+const char *selectorTypeName(SelectorType type);
+// return false and leave type unchanged if the name is unknown
+bool parseDetectorType(const std::string &name, DetectorType &type);
+bool parseDescriptorType(const std::string &name, DescriptorType &type);
+bool parseMatcherType(const std::string &name, MatcherType &type);
+bool parseSelectorType(const std::string &name, SelectorType &type);
+
+// detection on overlapping tiles of the image, which are processed in parallel. Each tile reports only the keypoints
+// inside its own part of the image, so that keypoints in the overlap are not found twice; Shi-Tomasi and Harris select
+// corners relative to the strongest corner of the tile rather than of the whole image.
+struct TiledDetectionOptions
+{
+    int tilesX, tilesY;      // 1 x 1 detects on the whole image
+    int overlap;             // [pixels] margin around each tile, so that the detectors see the surroundings of every keypoint
+    int maxKeypointsPerTile; // the keypoints with the highest response are kept for uniform coverage, 0 for no limit
+    size_t nThreads;         // size of the thread pool, the calling thread included
+
+    TiledDetectionOptions(int tilesX = 1, int tilesY = 1, int overlap = 32, int maxKeypointsPerTile = 0,
+                          size_t nThreads = std::thread::hardware_concurrency())
+        : tilesX(tilesX), tilesY(tilesY), overlap(overlap), maxKeypointsPerTile(maxKeypointsPerTile), nThreads(nThreads) {}
+
+    bool enabled() const { return tilesX * tilesY > 1; }
+};
+
+// detection restricted to the union of the object bounding boxes of a frame, see FeaturePipeline::setRegionsOfInterest;
+// the detectors only process the part of the image around the boxes, so that descriptors are computed for fewer keypoints
+struct RoiRestrictionOptions
+{
+    bool enabled;
+    double margin; // each box is enlarged by this fraction of its width and height on every side
+    int padding;   // [pixels] image context around the boxes which the detectors see, but which yields no keypoints
+
+    RoiRestrictionOptions(bool enabled = false, double margin = 0.1, int padding = 32)
+        : enabled(enabled), margin(margin), padding(padding) {}
+};
+
+struct FeaturePipelineConfig
+{
+    DetectorType detector;
+    DescriptorType descriptor;
+    MatcherType matcher;
+    SelectorType selector;
+    double minDescDistRatio; // distance ratio test of the KNN selector
+    TiledDetectionOptions tiling;
+    RoiRestrictionOptions roi;
+    GuidedMatchingOptions guided; // replaces the matcher and selector when keypoints are passed to match
+    KltTrackingOptions klt; // correspondences from optical flow with FeaturePipeline::track, no descriptors are needed
+    size_t nMatchThreads; // threads of the Hamming, LSH and guided matchers, the calling thread included
+
+    FeaturePipelineConfig(DetectorType detector = DetectorType::ShiTomasi, DescriptorType descriptor = DescriptorType::BRISK,
+                          MatcherType matcher = MatcherType::BruteForce, SelectorType selector = SelectorType::KNN,
+                          double minDescDistRatio = 0.8)
+        : detector(detector), descriptor(descriptor), matcher(matcher), selector(selector), minDescDistRatio(minDescDistRatio),
+          nMatchThreads(1) {}
+};
+
+// keypoint detector, descriptor extractor and matcher which are created once and reused for every frame, together with
+// the scratch buffers of the matcher; detect/describe and match may run on two different threads, but neither of them
+// on more than one thread at a time
+class FeaturePipeline
+{
+public:
+    explicit FeaturePipeline(const FeaturePipelineConfig &config = FeaturePipelineConfig());
+
+    const FeaturePipelineConfig &config() const { return cfg; }
+
+    // limits the following detections to the enlarged boxes if the ROI restriction is enabled, no boxes means no keypoints
+    void setRegionsOfInterest(const std::vector<BoundingBox> &boxes, cv::Size imgSize);
+
+    // keypoints are appended, imgGray must be a grayscale image
+    void detect(const cv::Mat &imgGray, std::vector<cv::KeyPoint> &keypoints, bool bVis = false);
+    // keypoints without a descriptor are removed by the extractor
+    void describe(const cv::Mat &img, std::vector<cv::KeyPoint> &keypoints, cv::Mat &descriptors);
+    // matches are appended, the descriptors are left unchanged; FLANN uses an LSH index for binary descriptors
+    void match(const cv::Mat &descSource, const cv::Mat &descRef, std::vector<cv::DMatch> &matches);
+    // with guided matching enabled, only keypoints within the search radius around the source keypoints shifted by
+    // predictedShift (one per source keypoint, or empty) are compared, see GuidedMatcher; the selector decides whether
+    // the ratio test is applied. Otherwise the keypoints are ignored and the descriptors are matched as above
+    void match(const std::vector<cv::KeyPoint> &kptsSource, const std::vector<cv::KeyPoint> &kptsRef,
+               const cv::Mat &descSource, const cv::Mat &descRef, std::vector<cv::DMatch> &matches,
+               const std::vector<cv::Point2f> &predictedShift = std::vector<cv::Point2f>());
+
+    // optical flow mode, replaces detect, describe and match : the keypoints of the previous call are tracked into imgGray
+    // and appended together with their matches (queryIdx = keypoint of the previous call, trainIdx = appended keypoint).
+    // Keypoints are detected in the first frame and whenever fewer than klt.minTracked could be tracked; they are added
+    // away from the tracked ones and have no match. Frames must be passed in sequence order, requires klt.enabled
+    void track(const cv::Mat &imgGray, std::vector<cv::KeyPoint> &keypoints, std::vector<cv::DMatch> &matches, bool bVis = false);
+    // same with the grayscale image and the pyramid of the frame's image cache, which are built there at most once
+    void track(ImageCache &images, std::vector<cv::KeyPoint> &keypoints, std::vector<cv::DMatch> &matches, bool bVis = false);
+    int redetections() const { return nRedetections; } // no. of frames of track in which keypoints were detected
+
+private:
+    void trackFrame(const cv::Mat &imgGray, const std::vector<cv::Mat> *pyramid, std::vector<cv::KeyPoint> &keypoints,
+                    std::vector<cv::DMatch> &matches, bool bVis);
+    void detectTiled(const cv::Mat &imgGray, std::vector<cv::KeyPoint> &keypoints);
+    void detectInRegion(const cv::Mat &imgGray, cv::Rect region, const cv::Ptr<cv::FeatureDetector> &regionDetector,
+                        std::vector<cv::KeyPoint> &keypoints);
+
+    FeaturePipelineConfig cfg;
+    cv::Ptr<cv::FeatureDetector> detector; // empty for Shi-Tomasi and Harris, which are plain function calls
+    cv::Ptr<cv::DescriptorExtractor> extractor;
+    cv::Ptr<cv::DescriptorMatcher> matcher; // empty if the Hamming matcher is used
+    std::unique_ptr<ThreadPool> matchPool;
+    std::unique_ptr<HammingMatcher> hammingMatcher; // brute force KNN matching of binary descriptors
+    std::unique_ptr<LshIndex> lshIndex; // FLANN matching of binary descriptors
+    std::unique_ptr<GuidedMatcher> guidedMatcher;
+    std::unique_ptr<KltTracker> kltTracker;
+    int nRedetections;
+
+    std::unique_ptr<ThreadPool> pool; // tiled detection only
+    std::vector<cv::Ptr<cv::FeatureDetector>> tileDetectors; // one per tile, empty for Harris
+    std::vector<std::vector<cv::KeyPoint>> tileKeypoints;
+
+    bool bRoiActive;
+    cv::Mat roiMask;   // 255 inside the enlarged boxes
+    cv::Rect roiBounds; // bounding rectangle of the enlarged boxes
+
+    std::vector<std::vector<cv::DMatch>> knnMatches;
+};
+
+#endif /* featurePipeline_hpp */
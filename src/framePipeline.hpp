@@ -0,0 +1,472 @@
+
+#ifndef framePipeline_hpp
+#define framePipeline_hpp
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+// thread-safe FIFO with a fixed capacity; push blocks while the queue is full (back-pressure) and pop blocks while it is empty
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(1, capacity)), bClosed(false), occupancySum(0.0), nSamples(0) {}
+
+    // moves item into the queue, returns false if the queue has been closed in the meantime
+    bool push(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        notFull.wait(lock, [this] { return bClosed || items.size() < capacity; });
+        if (bClosed)
+        {
+            return false;
+        }
+        items.push_back(std::move(item));
+        occupancySum += items.size();
+        ++nSamples;
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // removes the oldest item, returns false once the queue has been closed and all items have been taken
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        notEmpty.wait(lock, [this] { return bClosed || !items.empty(); });
+        if (items.empty())
+        {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // non-blocking variants, return false instead of waiting
+    bool tryPush(T &item)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (bClosed || items.size() >= capacity)
+        {
+            return false;
+        }
+        items.push_back(std::move(item));
+        occupancySum += items.size();
+        ++nSamples;
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool tryPop(T &item)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (items.empty())
+        {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // no more items will be pushed, consumers drain the remaining items
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        bClosed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // stop immediately and drop all remaining items (used when a stage fails)
+    void abort()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        bClosed = true;
+        items.clear();
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // average no. of items in the queue right after an insertion
+    double meanOccupancy() const
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return nSamples > 0 ? occupancySum / nSamples : 0.0;
+    }
+
+    size_t maxSize() const { return capacity; }
+
+private:
+    const size_t capacity;
+    std::deque<T> items;
+    bool bClosed;
+    double occupancySum;
+    size_t nSamples;
+
+    mutable std::mutex mtx;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+
+// timing information collected for a single pipeline stage (all times in seconds)
+struct StageStatistics
+{
+    std::string name;
+    size_t frames = 0;         // no. of frames processed by this stage
+    double busyTime = 0.0;     // time spent in the stage function
+    double maxLatency = 0.0;   // max. time spent on a single frame
+    double starvedTime = 0.0;  // time spent waiting for input
+    double blockedTime = 0.0;  // time spent waiting for the next stage to accept output
+    double queueOccupancy = 0.0; // mean no. of frames waiting in the input queue
+};
+
+
+// runs a fixed sequence of stages over a stream of jobs; in threaded mode each stage has its own thread and the stages
+// are connected by bounded queues, so that different frames occupy different stages at the same time. As every stage
+// is processed by exactly one thread and the queues are FIFO, jobs reach the sink in the order they were produced.
+template <typename Job>
+class FramePipeline
+{
+public:
+    typedef std::function<bool(Job &)> SourceFunction;       // fills the next job, returns false at the end of the sequence
+    typedef std::function<void(Job &)> StageFunction;
+    typedef std::function<void(std::vector<Job> &)> BatchStageFunction;
+
+    explicit FramePipeline(size_t queueCapacity = 2) : queueCapacity(queueCapacity), wallTime(0.0), latencySum(0.0), meanFrameLatency(0.0), maxFrameLatency(0.0), bThreaded(true) {}
+
+    void addStage(const std::string &name, StageFunction function)
+    {
+        addBatchStage(name, 1, [function](std::vector<Job> &jobs) {
+            for (auto it = jobs.begin(); it != jobs.end(); ++it)
+            {
+                function(*it);
+            }
+        });
+    }
+
+    // stage which collects up to batchSize jobs before processing them together (the last batch may be smaller)
+    void addBatchStage(const std::string &name, size_t batchSize, BatchStageFunction function)
+    {
+        Stage stage;
+        stage.batchSize = std::max<size_t>(1, batchSize);
+        stage.function = function;
+        stage.stats.name = name;
+        stages.push_back(stage);
+    }
+
+    // produces jobs with source on a loader thread, passes them through all stages and consumes them with sink on the
+    // calling thread; in non-threaded mode everything runs one after another on the calling thread (batch size 1)
+    void run(const std::string &sourceName, SourceFunction source, const std::string &sinkName, StageFunction sink, bool bThreaded = true)
+    {
+        this->bThreaded = bThreaded;
+        sourceStats = StageStatistics();
+        sourceStats.name = sourceName;
+        sinkStats = StageStatistics();
+        sinkStats.name = sinkName;
+        for (auto it = stages.begin(); it != stages.end(); ++it)
+        {
+            std::string name = it->stats.name;
+            it->stats = StageStatistics();
+            it->stats.name = name;
+        }
+        latencySum = 0.0;
+        maxFrameLatency = 0.0;
+
+        Clock::time_point tStart = Clock::now();
+        if (bThreaded)
+        {
+            runThreaded(source, sink);
+        }
+        else
+        {
+            runSequential(source, sink);
+        }
+        wallTime = seconds(tStart, Clock::now());
+        meanFrameLatency = sinkStats.frames > 0 ? latencySum / sinkStats.frames : 0.0;
+    }
+
+    void printReport() const
+    {
+        std::ios_base::fmtflags flags = std::cout.flags();
+        std::streamsize precision = std::cout.precision();
+        std::cout << "Pipeline report (" << (bThreaded ? "threaded" : "sequential") << ", " << sinkStats.frames << " frames in "
+                  << std::fixed << std::setprecision(1) << 1000 * wallTime << " ms, frame latency mean "
+                  << 1000 * meanFrameLatency << " ms / max " << 1000 * maxFrameLatency << " ms)" << std::endl;
+        std::cout << std::left << std::setw(12) << "stage" << std::right << std::setw(8) << "frames" << std::setw(12) << "ms/frame"
+                  << std::setw(12) << "max ms" << std::setw(12) << "occupancy" << std::setw(12) << "starved ms" << std::setw(12)
+                  << "blocked ms" << std::setw(12) << "queue" << std::endl;
+        printStage(sourceStats);
+        for (auto it = stages.begin(); it != stages.end(); ++it)
+        {
+            printStage(it->stats);
+        }
+        printStage(sinkStats);
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot
+    {
+        Job job;
+        Clock::time_point tCreated;
+    };
+
+    struct Stage
+    {
+        size_t batchSize;
+        BatchStageFunction function;
+        StageStatistics stats;
+    };
+
+    static double seconds(Clock::time_point t0, Clock::time_point t1)
+    {
+        return std::chrono::duration<double>(t1 - t0).count();
+    }
+
+    static void addSample(StageStatistics &stats, double t, size_t frames)
+    {
+        stats.busyTime += t;
+        stats.maxLatency = std::max(stats.maxLatency, t / frames);
+        stats.frames += frames;
+    }
+
+    void finishFrame(const Slot &slot)
+    {
+        double latency = seconds(slot.tCreated, Clock::now());
+        latencySum += latency;
+        maxFrameLatency = std::max(maxFrameLatency, latency);
+    }
+
+    void printStage(const StageStatistics &stats) const
+    {
+        double msPerFrame = stats.frames > 0 ? 1000 * stats.busyTime / stats.frames : 0.0;
+        double occupancy = wallTime > 0.0 ? 100.0 * stats.busyTime / wallTime : 0.0;
+        std::cout << std::left << std::setw(12) << stats.name << std::right << std::setw(8) << stats.frames << std::setw(12) << msPerFrame
+                  << std::setw(12) << 1000 * stats.maxLatency << std::setw(11) << occupancy << "%" << std::setw(12) << 1000 * stats.starvedTime
+                  << std::setw(12) << 1000 * stats.blockedTime << std::setw(12) << stats.queueOccupancy << std::endl;
+    }
+
+    void runSequential(SourceFunction &source, StageFunction &sink)
+    {
+        std::vector<Job> jobs(1);
+        while (true)
+        {
+            Clock::time_point t0 = Clock::now();
+            if (!source(jobs[0]))
+            {
+                break;
+            }
+            Clock::time_point tCreated = t0;
+            t0 = Clock::now();
+            addSample(sourceStats, seconds(tCreated, t0), 1);
+
+            for (auto it = stages.begin(); it != stages.end(); ++it)
+            {
+                it->function(jobs);
+                Clock::time_point t1 = Clock::now();
+                addSample(it->stats, seconds(t0, t1), 1);
+                t0 = t1;
+            }
+
+            sink(jobs[0]);
+            Clock::time_point t1 = Clock::now();
+            addSample(sinkStats, seconds(t0, t1), 1);
+
+            Slot slot;
+            slot.tCreated = tCreated;
+            finishFrame(slot);
+            jobs[0] = Job();
+        }
+    }
+
+    void runThreaded(SourceFunction &source, StageFunction &sink)
+    {
+        // queue i connects stage i-1 (or the source) with stage i (or the sink)
+        std::vector<std::unique_ptr<BoundedQueue<Slot>>> queues;
+        for (size_t i = 0; i <= stages.size(); ++i)
+        {
+            queues.push_back(std::unique_ptr<BoundedQueue<Slot>>(new BoundedQueue<Slot>(queueCapacity)));
+        }
+
+        std::exception_ptr error;
+        std::mutex errorMtx;
+        auto fail = [&]() {
+            std::lock_guard<std::mutex> lock(errorMtx);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+            for (auto it = queues.begin(); it != queues.end(); ++it)
+            {
+                (*it)->abort();
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        // loader thread
+        threads.push_back(std::thread([&]() {
+            try
+            {
+                while (true)
+                {
+                    Slot slot;
+                    Clock::time_point t0 = Clock::now();
+                    if (!source(slot.job))
+                    {
+                        break;
+                    }
+                    slot.tCreated = t0;
+                    Clock::time_point t1 = Clock::now();
+                    addSample(sourceStats, seconds(t0, t1), 1);
+                    if (!queues[0]->push(slot))
+                    {
+                        break;
+                    }
+                    sourceStats.blockedTime += seconds(t1, Clock::now());
+                }
+                queues[0]->close();
+            }
+            catch (...)
+            {
+                fail();
+            }
+        }));
+
+        // one thread per processing stage
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            threads.push_back(std::thread([&, i]() {
+                Stage &stage = stages[i];
+                BoundedQueue<Slot> &input = *queues[i];
+                BoundedQueue<Slot> &output = *queues[i + 1];
+                try
+                {
+                    std::vector<Slot> slots;
+                    std::vector<Job> jobs;
+                    bool bInputOpen = true;
+                    while (bInputOpen)
+                    {
+                        // collect the next batch
+                        slots.clear();
+                        Clock::time_point t0 = Clock::now();
+                        while (slots.size() < stage.batchSize)
+                        {
+                            Slot slot;
+                            if (!input.pop(slot))
+                            {
+                                bInputOpen = false;
+                                break;
+                            }
+                            slots.push_back(std::move(slot));
+                        }
+                        Clock::time_point t1 = Clock::now();
+                        stage.stats.starvedTime += seconds(t0, t1);
+                        if (slots.empty())
+                        {
+                            break;
+                        }
+
+                        jobs.resize(slots.size());
+                        for (size_t k = 0; k < slots.size(); ++k)
+                        {
+                            jobs[k] = std::move(slots[k].job);
+                        }
+                        stage.function(jobs);
+                        for (size_t k = 0; k < slots.size(); ++k)
+                        {
+                            slots[k].job = std::move(jobs[k]);
+                        }
+                        Clock::time_point t2 = Clock::now();
+                        addSample(stage.stats, seconds(t1, t2), slots.size());
+
+                        for (size_t k = 0; k < slots.size(); ++k)
+                        {
+                            if (!output.push(slots[k]))
+                            {
+                                return;
+                            }
+                        }
+                        stage.stats.blockedTime += seconds(t2, Clock::now());
+                    }
+                    output.close();
+                }
+                catch (...)
+                {
+                    fail();
+                }
+            }));
+        }
+
+        // matching and TTC computation remain on the calling thread (e.g. for visualization)
+        try
+        {
+            BoundedQueue<Slot> &input = *queues.back();
+            while (true)
+            {
+                Slot slot;
+                Clock::time_point t0 = Clock::now();
+                if (!input.pop(slot))
+                {
+                    break;
+                }
+                Clock::time_point t1 = Clock::now();
+                sinkStats.starvedTime += seconds(t0, t1);
+                sink(slot.job);
+                addSample(sinkStats, seconds(t1, Clock::now()), 1);
+                finishFrame(slot);
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+
+        for (auto it = threads.begin(); it != threads.end(); ++it)
+        {
+            it->join();
+        }
+
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            stages[i].stats.queueOccupancy = queues[i]->meanOccupancy();
+        }
+        sinkStats.queueOccupancy = queues.back()->meanOccupancy();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    size_t queueCapacity;
+    std::vector<Stage> stages;
+    StageStatistics sourceStats;
+    StageStatistics sinkStats;
+
+    double wallTime;         // duration of the last run in seconds
+    double latencySum;
+    double meanFrameLatency; // time from loading a frame until the sink has finished it
+    double maxFrameLatency;
+    bool bThreaded;
+};
+
+#endif /* framePipeline_hpp */
@@ -0,0 +1,61 @@
+
+#ifndef frameRingBuffer_hpp
+#define frameRingBuffer_hpp
+
+#include <array>
+#include <utility>
+#include <stdexcept>
+
+// fixed-capacity ring buffer holding the N most recent frames; slots are recycled in place instead of growing a vector
+template <typename T, size_t N>
+class FrameRingBuffer
+{
+    static_assert(N > 0, "FrameRingBuffer needs at least one slot");
+
+public:
+    FrameRingBuffer() : head(0), count(0) {}
+
+    // moves frame into the slot of the oldest entry and hands the previous contents of that slot back in frame,
+    // so that the caller can re-use its buffers (cv::Mat data, vector capacity) for one of the next frames
+    T &push(T &frame)
+    {
+        head = (head + 1) % N;
+        std::swap(slots[head], frame);
+        if (count < N)
+        {
+            ++count;
+        }
+        return slots[head];
+    }
+
+    // most recent frame
+    T &curr() { return at(0); }
+    const T &curr() const { return at(0); }
+
+    // frame before the most recent one
+    T &prev() { return at(1); }
+    const T &prev() const { return at(1); }
+
+    // frame which has been pushed age frames before the most recent one
+    T &at(size_t age)
+    {
+        if (age >= count)
+        {
+            throw std::out_of_range("FrameRingBuffer: no frame of the requested age");
+        }
+        return slots[(head + N - age) % N];
+    }
+    const T &at(size_t age) const { return const_cast<FrameRingBuffer *>(this)->at(age); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    static size_t capacity() { return N; }
+
+private:
+    std::array<T, N> slots;
+    size_t head;  // slot of the most recent frame
+    size_t count; // no. of valid frames
+};
+
+#endif /* frameRingBuffer_hpp */
@@ -0,0 +1,200 @@
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "guidedMatcher.hpp"
+#include "hammingMatcher.hpp"
+
+using namespace std;
+
+// best and second best L2 distance of the listed train rows for a single float query descriptor
+static void bestTwoL2(const float *query, const cv::Mat &train, const int *candidates, int nCandidates,
+                      int &bestIdx, float &best, float &second)
+{
+    float bestSq = numeric_limits<float>::max(), secondSq = numeric_limits<float>::max();
+    bestIdx = -1;
+    for (int k = 0; k < nCandidates; ++k)
+    {
+        const float *row = train.ptr<float>(candidates[k]);
+        float distanceSq = 0.0f;
+        for (int d = 0; d < train.cols; ++d)
+        {
+            float diff = query[d] - row[d];
+            distanceSq += diff * diff;
+        }
+        if (distanceSq < bestSq)
+        {
+            secondSq = bestSq;
+            bestSq = distanceSq;
+            bestIdx = candidates[k];
+        }
+        else if (distanceSq < secondSq)
+        {
+            secondSq = distanceSq;
+        }
+    }
+    best = sqrt(bestSq);
+    second = secondSq == numeric_limits<float>::max() ? numeric_limits<float>::infinity() : sqrt(secondSq);
+}
+
+GuidedMatcher::GuidedMatcher(float searchRadius, double minDescDistRatio, ThreadPool *pool)
+    : searchRadius(searchRadius), minDescDistRatio(minDescDistRatio), pool(pool), meanCompared(0.0), cols(0), rows(0)
+{
+    if (!(searchRadius > 0.0f))
+    {
+        throw invalid_argument("GuidedMatcher: searchRadius must be positive");
+    }
+}
+
+void GuidedMatcher::buildGrid(const vector<cv::KeyPoint> &kptsPrev, const vector<cv::Point2f> &predictedShift)
+{
+    positions.resize(kptsPrev.size());
+    cv::Point2f minPt(numeric_limits<float>::max(), numeric_limits<float>::max());
+    cv::Point2f maxPt(-numeric_limits<float>::max(), -numeric_limits<float>::max());
+    for (size_t i = 0; i < kptsPrev.size(); ++i)
+    {
+        positions[i] = predictedShift.empty() ? kptsPrev[i].pt : kptsPrev[i].pt + predictedShift[i];
+        minPt.x = min(minPt.x, positions[i].x);
+        minPt.y = min(minPt.y, positions[i].y);
+        maxPt.x = max(maxPt.x, positions[i].x);
+        maxPt.y = max(maxPt.y, positions[i].y);
+    }
+    origin = minPt;
+    cols = (int)((maxPt.x - minPt.x) / searchRadius) + 1;
+    rows = (int)((maxPt.y - minPt.y) / searchRadius) + 1;
+
+    // counting sort of the keypoint indices by cell
+    vector<int> cellOf(positions.size());
+    cellStart.assign(cols * rows + 1, 0);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        int cx = (int)((positions[i].x - origin.x) / searchRadius), cy = (int)((positions[i].y - origin.y) / searchRadius);
+        cellOf[i] = cy * cols + cx;
+        ++cellStart[cellOf[i] + 1];
+    }
+    for (int c = 0; c < cols * rows; ++c)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+    cellEntries.resize(positions.size());
+    vector<int> next(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        cellEntries[next[cellOf[i]]++] = i;
+    }
+}
+
+void GuidedMatcher::matchRows(const vector<cv::KeyPoint> &kptsCurr, const cv::Mat &descPrev, const cv::Mat &descCurr,
+                              int rowBegin, int rowEnd, vector<int> &candidates, vector<cv::DMatch> &rowMatches,
+                              size_t &nCandidates) const
+{
+    float radiusSq = searchRadius * searchRadius;
+    bool bBinary = descPrev.type() == CV_8U;
+    for (int j = rowBegin; j < rowEnd; ++j)
+    {
+        // previous keypoints within the search radius, found in the cells overlapped by the search window
+        const cv::Point2f &pt = kptsCurr[j].pt;
+        int cx0 = max(0, (int)floor((pt.x - searchRadius - origin.x) / searchRadius));
+        int cx1 = min(cols - 1, (int)floor((pt.x + searchRadius - origin.x) / searchRadius));
+        int cy0 = max(0, (int)floor((pt.y - searchRadius - origin.y) / searchRadius));
+        int cy1 = min(rows - 1, (int)floor((pt.y + searchRadius - origin.y) / searchRadius));
+        candidates.clear();
+        for (int cy = cy0; cy <= cy1; ++cy)
+        {
+            for (int cx = cx0; cx <= cx1; ++cx)
+            {
+                int c = cy * cols + cx;
+                for (int e = cellStart[c]; e < cellStart[c + 1]; ++e)
+                {
+                    cv::Point2f d = positions[cellEntries[e]] - pt;
+                    if (d.x * d.x + d.y * d.y <= radiusSq)
+                    {
+                        candidates.push_back(cellEntries[e]);
+                    }
+                }
+            }
+        }
+        nCandidates += candidates.size();
+
+        int bestIdx = -1;
+        float best = 0.0f, second = numeric_limits<float>::infinity();
+        if (candidates.empty())
+        {
+            // no previous keypoint within the search radius, nothing to compare
+        }
+        else if (bBinary)
+        {
+            HammingBestTwo result = hammingBestTwo(descCurr.ptr<uchar>(j), descPrev, candidates.data(), candidates.size());
+            bestIdx = result.bestIdx;
+            best = result.best;
+            second = result.second == numeric_limits<int>::max() ? numeric_limits<float>::infinity() : result.second;
+        }
+        else
+        {
+            bestTwoL2(descCurr.ptr<float>(j), descPrev, candidates.data(), candidates.size(), bestIdx, best, second);
+        }
+        // a lone candidate has no second neighbour for the ratio test; without ratio test the best candidate is always kept
+        bool bMatch = bestIdx >= 0 && (std::isinf(minDescDistRatio) || (!std::isinf(second) && best < minDescDistRatio * second));
+        rowMatches.push_back(bMatch ? cv::DMatch(bestIdx, j, best) : cv::DMatch(-1, -1, 0.0f));
+    }
+}
+
+void GuidedMatcher::match(const vector<cv::KeyPoint> &kptsPrev, const vector<cv::KeyPoint> &kptsCurr,
+                          const cv::Mat &descPrev, const cv::Mat &descCurr, const vector<cv::Point2f> &predictedShift,
+                          vector<cv::DMatch> &matches)
+{
+    meanCompared = 0.0;
+    if (descPrev.empty() || descCurr.empty())
+    {
+        return;
+    }
+    if (descPrev.type() != descCurr.type() || descPrev.cols != descCurr.cols ||
+        (descPrev.type() != CV_8U && descPrev.type() != CV_32F))
+    {
+        throw invalid_argument("GuidedMatcher: descriptors must be both binary or both float and of equal width");
+    }
+    if (kptsPrev.size() != (size_t)descPrev.rows || kptsCurr.size() != (size_t)descCurr.rows ||
+        (!predictedShift.empty() && predictedShift.size() != kptsPrev.size()))
+    {
+        throw invalid_argument("GuidedMatcher: one keypoint (and predicted shift) per descriptor row required");
+    }
+
+    buildGrid(kptsPrev, predictedShift);
+
+    size_t nCandidates = 0;
+    rowMatches.clear();
+    if (!pool || pool->size() == 1)
+    {
+        matchRows(kptsCurr, descPrev, descCurr, 0, descCurr.rows, candidateScratch, rowMatches, nCandidates);
+    }
+    else
+    {
+        // blocks of current keypoints, each block writes its own range of slots so that the order of the matches is preserved
+        rowMatches.resize(descCurr.rows);
+        const int blockSize = 64;
+        int nBlocks = (descCurr.rows + blockSize - 1) / blockSize;
+        vector<size_t> blockCandidates(nBlocks, 0);
+        pool->parallelFor(nBlocks, [&](size_t block) {
+            int rowBegin = block * blockSize, rowEnd = min(descCurr.rows, rowBegin + blockSize);
+            vector<int> candidates;
+            vector<cv::DMatch> blockMatches;
+            matchRows(kptsCurr, descPrev, descCurr, rowBegin, rowEnd, candidates, blockMatches, blockCandidates[block]);
+            copy(blockMatches.begin(), blockMatches.end(), rowMatches.begin() + rowBegin);
+        });
+        for (size_t n : blockCandidates)
+        {
+            nCandidates += n;
+        }
+    }
+    meanCompared = (double)nCandidates / descCurr.rows;
+
+    for (auto it = rowMatches.begin(); it != rowMatches.end(); ++it)
+    {
+        if (it->queryIdx >= 0)
+        {
+            matches.push_back(*it);
+        }
+    }
+}
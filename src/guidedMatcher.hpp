@@ -0,0 +1,64 @@
+
+#ifndef guidedMatcher_hpp
+#define guidedMatcher_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "threadPool.hpp"
+
+// matching restricted to keypoints near each other in the two frames, see GuidedMatcher
+struct GuidedMatchingOptions
+{
+    bool enabled;
+    float searchRadius;  // [pixels] around the predicted position of a keypoint of the previous frame
+    bool bPredictMotion; // shift the keypoints on tracked objects by the last motion of their box, see TrackManager
+
+    GuidedMatchingOptions(bool enabled = false, float searchRadius = 40.0f, bool bPredictMotion = true)
+        : enabled(enabled), searchRadius(searchRadius), bPredictMotion(bPredictMotion) {}
+};
+
+// windowed keypoint matching between two successive frames : the keypoints of the previous frame are bucketed into a
+// uniform grid at their predicted position in the current frame (cell size = search radius), and each keypoint of the
+// current frame is only compared with the descriptors of the previous keypoints within the search radius. The ratio test
+// is applied to the best and second best candidate of the window; a keypoint with a single candidate has no second
+// neighbour and gets no match, like one without candidates.
+// Binary descriptors use the Hamming distance, float descriptors (SIFT) the L2 distance.
+class GuidedMatcher
+{
+public:
+    // minDescDistRatio = infinity keeps the best candidate of every keypoint; with a pool, blocks of current keypoints
+    // are matched in parallel
+    explicit GuidedMatcher(float searchRadius = 40.0f, double minDescDistRatio = 0.8, ThreadPool *pool = nullptr);
+
+    // predictedShift holds the expected motion of each keypoint of the previous frame (empty for none). Matches are
+    // appended in the order of the current keypoints, with queryIdx = previous and trainIdx = current keypoint, like
+    // FeaturePipeline::match with the previous frame as source
+    void match(const std::vector<cv::KeyPoint> &kptsPrev, const std::vector<cv::KeyPoint> &kptsCurr,
+               const cv::Mat &descPrev, const cv::Mat &descCurr, const std::vector<cv::Point2f> &predictedShift,
+               std::vector<cv::DMatch> &matches);
+
+    // average no. of descriptor comparisons per current keypoint in the last call
+    double meanCandidates() const { return meanCompared; }
+
+private:
+    void buildGrid(const std::vector<cv::KeyPoint> &kptsPrev, const std::vector<cv::Point2f> &predictedShift);
+    void matchRows(const std::vector<cv::KeyPoint> &kptsCurr, const cv::Mat &descPrev, const cv::Mat &descCurr,
+                   int rowBegin, int rowEnd, std::vector<int> &candidates, std::vector<cv::DMatch> &rowMatches,
+                   size_t &nCandidates) const;
+
+    float searchRadius;
+    double minDescDistRatio;
+    ThreadPool *pool;
+    double meanCompared;
+
+    cv::Point2f origin; // top-left corner of the grid
+    int cols, rows;
+    std::vector<cv::Point2f> positions; // predicted position of every keypoint of the previous frame
+    std::vector<int> cellStart;         // keypoints of cell c are cellEntries[cellStart[c]] ... cellEntries[cellStart[c+1]-1]
+    std::vector<int> cellEntries;
+    std::vector<int> candidateScratch;
+    std::vector<cv::DMatch> rowMatches; // one entry per current keypoint in parallel mode, queryIdx < 0 if there is no match
+};
+
+#endif /* guidedMatcher_hpp */
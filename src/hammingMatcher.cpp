@@ -0,0 +1,270 @@
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "hammingMatcher.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAMMING_X86 1
+#endif
+
+using namespace std;
+
+static inline void updateBestTwo(HammingBestTwo &result, int distance, int trainIdx)
+{
+    if (distance < result.best)
+    {
+        result.second = result.best;
+        result.best = distance;
+        result.bestIdx = trainIdx;
+    }
+    else if (distance < result.second)
+    {
+        result.second = distance;
+    }
+}
+
+static inline uint64_t loadWord(const uchar *p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word)); // descriptor rows need not be aligned
+    return word;
+}
+
+static inline int popcountSWAR(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+// bCandidates is a template parameter, so that scanning all rows is not slowed down by the indirection
+template <bool bCandidates>
+static HammingBestTwo bestTwoScalar(const uchar *query, const cv::Mat &train, int nBytes, const int *candidates, int nCandidates)
+{
+    HammingBestTwo result = {-1, numeric_limits<int>::max(), numeric_limits<int>::max()};
+    int nWords = nBytes / 8;
+    for (int k = 0; k < nCandidates; ++k)
+    {
+        int j = bCandidates ? candidates[k] : k;
+        const uchar *row = train.ptr<uchar>(j);
+        int distance = 0;
+        for (int w = 0; w < nWords; ++w)
+        {
+            distance += popcountSWAR(loadWord(query + 8 * w) ^ loadWord(row + 8 * w));
+        }
+        for (int b = 8 * nWords; b < nBytes; ++b)
+        {
+            distance += popcountSWAR(query[b] ^ row[b]);
+        }
+        updateBestTwo(result, distance, j);
+    }
+    return result;
+}
+
+#ifdef HAMMING_X86
+
+template <bool bCandidates>
+__attribute__((target("popcnt")))
+static HammingBestTwo bestTwoPopcnt(const uchar *query, const cv::Mat &train, int nBytes, const int *candidates, int nCandidates)
+{
+    HammingBestTwo result = {-1, numeric_limits<int>::max(), numeric_limits<int>::max()};
+    int nWords = nBytes / 8;
+    for (int k = 0; k < nCandidates; ++k)
+    {
+        int j = bCandidates ? candidates[k] : k;
+        const uchar *row = train.ptr<uchar>(j);
+        int distance = 0;
+        for (int w = 0; w < nWords; ++w)
+        {
+            distance += __builtin_popcountll(loadWord(query + 8 * w) ^ loadWord(row + 8 * w));
+        }
+        for (int b = 8 * nWords; b < nBytes; ++b)
+        {
+            distance += __builtin_popcount(query[b] ^ row[b]);
+        }
+        updateBestTwo(result, distance, j);
+    }
+    return result;
+}
+
+// population count of 32 bytes per instruction sequence : 4-bit table lookups with vpshufb, summed by vpsadbw
+template <bool bCandidates>
+__attribute__((target("avx2,popcnt")))
+static HammingBestTwo bestTwoAVX2(const uchar *query, const cv::Mat &train, int nBytes, const int *candidates, int nCandidates)
+{
+    HammingBestTwo result = {-1, numeric_limits<int>::max(), numeric_limits<int>::max()};
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+    int nChunks = nBytes / 32, nWords = (nBytes % 32) / 8;
+    int tailBegin = 32 * nChunks + 8 * nWords;
+
+    for (int k = 0; k < nCandidates; ++k)
+    {
+        int j = bCandidates ? candidates[k] : k;
+        const uchar *row = train.ptr<uchar>(j);
+        __m256i counts = _mm256_setzero_si256();
+        for (int c = 0; c < nChunks; ++c)
+        {
+            __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(query + 32 * c)),
+                                         _mm256_loadu_si256((const __m256i *)(row + 32 * c)));
+            __m256i bits = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x, lowNibbles)),
+                                           _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowNibbles)));
+            counts = _mm256_add_epi64(counts, _mm256_sad_epu8(bits, _mm256_setzero_si256()));
+        }
+        __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+        // the two 64-bit lanes hold small counts, their low halves are read with 32-bit extracts which 32-bit x86 has too
+        int distance = _mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 2);
+
+        for (int w = 0; w < nWords; ++w)
+        {
+            distance += __builtin_popcountll(loadWord(query + 32 * nChunks + 8 * w) ^ loadWord(row + 32 * nChunks + 8 * w));
+        }
+        for (int b = tailBegin; b < nBytes; ++b)
+        {
+            distance += __builtin_popcount(query[b] ^ row[b]);
+        }
+        updateBestTwo(result, distance, j);
+    }
+    return result;
+}
+
+#endif /* HAMMING_X86 */
+
+bool isHammingKernelSupported(HammingKernel kernel)
+{
+    switch (kernel)
+    {
+    case HammingKernel::Auto:
+    case HammingKernel::Scalar:
+        return true;
+#ifdef HAMMING_X86
+    case HammingKernel::Popcnt:
+        return __builtin_cpu_supports("popcnt");
+    case HammingKernel::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+    default:
+        return false;
+    }
+}
+
+HammingKernel bestHammingKernel()
+{
+    static const HammingKernel best = isHammingKernelSupported(HammingKernel::AVX2) ? HammingKernel::AVX2
+                                    : isHammingKernelSupported(HammingKernel::Popcnt) ? HammingKernel::Popcnt
+                                    : HammingKernel::Scalar;
+    return best;
+}
+
+const char *hammingKernelName(HammingKernel kernel)
+{
+    switch (kernel)
+    {
+    case HammingKernel::Auto:
+        return hammingKernelName(bestHammingKernel());
+    case HammingKernel::Scalar:
+        return "scalar";
+    case HammingKernel::Popcnt:
+        return "popcnt";
+    case HammingKernel::AVX2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+
+// bAllRows selects the scan over all train rows, so that an empty candidate list is never mistaken for it
+static HammingBestTwo bestTwo(const uchar *query, const cv::Mat &train, bool bAllRows, const int *candidates, int nCandidates,
+                              HammingKernel kernel)
+{
+    if (kernel == HammingKernel::Auto || !isHammingKernelSupported(kernel))
+    {
+        kernel = bestHammingKernel();
+    }
+    int nBytes = train.cols;
+
+#ifdef HAMMING_X86
+    if (kernel == HammingKernel::AVX2)
+    {
+        return bAllRows ? bestTwoAVX2<false>(query, train, nBytes, candidates, nCandidates)
+                        : bestTwoAVX2<true>(query, train, nBytes, candidates, nCandidates);
+    }
+    if (kernel == HammingKernel::Popcnt)
+    {
+        return bAllRows ? bestTwoPopcnt<false>(query, train, nBytes, candidates, nCandidates)
+                        : bestTwoPopcnt<true>(query, train, nBytes, candidates, nCandidates);
+    }
+#endif
+    return bAllRows ? bestTwoScalar<false>(query, train, nBytes, candidates, nCandidates)
+                    : bestTwoScalar<true>(query, train, nBytes, candidates, nCandidates);
+}
+
+HammingBestTwo hammingBestTwo(const uchar *query, const cv::Mat &train, HammingKernel kernel)
+{
+    return bestTwo(query, train, true, nullptr, train.rows, kernel);
+}
+
+HammingBestTwo hammingBestTwo(const uchar *query, const cv::Mat &train, const int *candidates, int nCandidates, HammingKernel kernel)
+{
+    return bestTwo(query, train, false, candidates, nCandidates, kernel);
+}
+
+HammingMatcher::HammingMatcher(double minDescDistRatio, HammingKernel kernel, ThreadPool *pool)
+    : minDescDistRatio(minDescDistRatio), kernelType(kernel), pool(pool)
+{
+    if (kernelType == HammingKernel::Auto || !isHammingKernelSupported(kernelType))
+    {
+        kernelType = bestHammingKernel();
+    }
+}
+
+void HammingMatcher::match(const cv::Mat &descQuery, const cv::Mat &descTrain, vector<cv::DMatch> &matches)
+{
+    if (descQuery.empty() || descTrain.rows < 2)
+    {
+        return; // no second best match for the ratio test
+    }
+    if (descQuery.type() != CV_8U || descTrain.type() != CV_8U || descQuery.cols != descTrain.cols)
+    {
+        throw invalid_argument("HammingMatcher: descriptors must be binary and of equal width");
+    }
+
+    if (!pool || pool->size() == 1)
+    {
+        for (int i = 0; i < descQuery.rows; ++i)
+        {
+            HammingBestTwo result = hammingBestTwo(descQuery.ptr<uchar>(i), descTrain, kernelType);
+            if (result.best < minDescDistRatio * result.second)
+            {
+                matches.push_back(cv::DMatch(i, result.bestIdx, (float)result.best));
+            }
+        }
+        return;
+    }
+
+    // blocks of query rows in parallel, each row writes its own slot so that the order of the matches is preserved
+    rowMatches.resize(descQuery.rows);
+    const int blockSize = 64;
+    int nBlocks = (descQuery.rows + blockSize - 1) / blockSize;
+    pool->parallelFor(nBlocks, [&](size_t block) {
+        int rowEnd = min(descQuery.rows, (int)(block + 1) * blockSize);
+        for (int i = block * blockSize; i < rowEnd; ++i)
+        {
+            HammingBestTwo result = hammingBestTwo(descQuery.ptr<uchar>(i), descTrain, kernelType);
+            rowMatches[i] = result.best < minDescDistRatio * result.second ? cv::DMatch(i, result.bestIdx, (float)result.best)
+                                                                          : cv::DMatch(-1, -1, 0.0f);
+        }
+    });
+    for (int i = 0; i < descQuery.rows; ++i)
+    {
+        if (rowMatches[i].queryIdx >= 0)
+        {
+            matches.push_back(rowMatches[i]);
+        }
+    }
+}
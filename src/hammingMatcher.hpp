@@ -0,0 +1,52 @@
+
+#ifndef hammingMatcher_hpp
+#define hammingMatcher_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "threadPool.hpp"
+
+// instruction set used for the Hamming distances, Auto picks the widest one supported by the CPU at runtime
+enum class HammingKernel { Auto, Scalar, Popcnt, AVX2 };
+
+bool isHammingKernelSupported(HammingKernel kernel);
+HammingKernel bestHammingKernel();
+const char *hammingKernelName(HammingKernel kernel);
+
+struct HammingBestTwo
+{
+    int bestIdx;     // -1 if there was no candidate
+    int best, second; // INT_MAX if there was no (second) candidate
+};
+
+// best and second best of all train rows for a single query descriptor with the width of the train descriptors
+HammingBestTwo hammingBestTwo(const uchar *query, const cv::Mat &train, HammingKernel kernel = HammingKernel::Auto);
+// same over the nCandidates train rows listed in candidates; nCandidates == 0 means no candidates (bestIdx = -1), whatever
+// candidates points to
+HammingBestTwo hammingBestTwo(const uchar *query, const cv::Mat &train, const int *candidates, int nCandidates,
+                              HammingKernel kernel = HammingKernel::Auto);
+
+// brute force matching of binary descriptors (CV_8U rows of equal width) with the distance ratio test : for every query
+// row the best and second best train row are tracked while scanning, and a match is emitted if the best distance is
+// below minDescDistRatio times the second best. Gives the same matches as cv::BFMatcher(NORM_HAMMING)::knnMatch with
+// k=2 followed by the ratio test, without the intermediate lists of candidates.
+class HammingMatcher
+{
+public:
+    // with a pool, the query rows are split into blocks which are matched in parallel
+    explicit HammingMatcher(double minDescDistRatio = 0.8, HammingKernel kernel = HammingKernel::Auto, ThreadPool *pool = nullptr);
+
+    // matches are appended in the order of the query rows (queryIdx = row of descQuery, trainIdx = row of descTrain)
+    void match(const cv::Mat &descQuery, const cv::Mat &descTrain, std::vector<cv::DMatch> &matches);
+
+    HammingKernel kernel() const { return kernelType; }
+
+private:
+    double minDescDistRatio;
+    HammingKernel kernelType;
+    ThreadPool *pool;
+    std::vector<cv::DMatch> rowMatches; // one entry per query row in parallel mode, queryIdx < 0 if the row has no match
+};
+
+#endif /* hammingMatcher_hpp */
@@ -0,0 +1,85 @@
+
+#include <limits>
+#include <algorithm>
+
+#include "hungarian.hpp"
+
+using namespace std;
+
+double solveAssignment(const std::vector<double> &cost, int rows, int cols, std::vector<int> &rowToCol)
+{
+    rowToCol.assign(rows, -1);
+    if (rows == 0 || cols == 0)
+    {
+        return 0.0;
+    }
+
+    // pad to a square matrix with zero cost, then run the O(n^3) shortest augmenting path version with potentials
+    int n = max(rows, cols);
+    const double inf = numeric_limits<double>::infinity();
+    vector<double> u(n + 1, 0.0), v(n + 1, 0.0); // row and column potentials
+    vector<int> p(n + 1, 0), way(n + 1, 0); // p[j] is the row assigned to column j (1-based, 0 for none)
+    for (int i = 1; i <= n; ++i)
+    {
+        p[0] = i;
+        int j0 = 0;
+        vector<double> minv(n + 1, inf);
+        vector<char> used(n + 1, false);
+        do
+        {
+            used[j0] = true;
+            int i0 = p[j0], j1 = 0;
+            double delta = inf;
+            for (int j = 1; j <= n; ++j)
+            {
+                if (used[j])
+                {
+                    continue;
+                }
+                double c = (i0 <= rows && j <= cols) ? cost[(i0 - 1) * cols + (j - 1)] : 0.0;
+                double cur = c - u[i0] - v[j];
+                if (cur < minv[j])
+                {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta)
+                {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= n; ++j)
+            {
+                if (used[j])
+                {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+
+        do // augment along the path found
+        {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    double total = 0.0;
+    for (int j = 1; j <= n; ++j)
+    {
+        if (p[j] >= 1 && p[j] <= rows && j <= cols)
+        {
+            rowToCol[p[j] - 1] = j - 1;
+            total += cost[(p[j] - 1) * cols + (j - 1)];
+        }
+    }
+    return total;
+}
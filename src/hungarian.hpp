@@ -0,0 +1,11 @@
+
+#ifndef hungarian_hpp
+#define hungarian_hpp
+
+#include <vector>
+
+// optimal one-to-one assignment (Hungarian method) for a row-major rows x cols cost matrix, minimizing the total cost;
+// rowToCol[r] is the column assigned to row r or -1 if the row is left unassigned because there are fewer columns
+double solveAssignment(const std::vector<double> &cost, int rows, int cols, std::vector<int> &rowToCol);
+
+#endif /* hungarian_hpp */
@@ -0,0 +1,56 @@
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include "imageCache.hpp"
+
+using namespace std;
+
+// a buffer which someone else still references must not be overwritten in place
+static void releaseIfShared(cv::Mat &img)
+{
+    if (img.u && img.u->refcount > 1)
+    {
+        img.release();
+    }
+}
+
+void ImageCache::reset(const cv::Mat &img)
+{
+    colorImg = img;
+    bGray = false;
+    pyramidMaxLevel = -1;
+    releaseIfShared(grayImg);
+    for (auto it = pyramid.begin(); it != pyramid.end(); ++it)
+    {
+        releaseIfShared(*it);
+    }
+}
+
+const cv::Mat &ImageCache::gray()
+{
+    if (!bGray)
+    {
+        if (colorImg.channels() == 1)
+        {
+            grayImg = colorImg;
+        }
+        else
+        {
+            cv::cvtColor(colorImg, grayImg, cv::COLOR_BGR2GRAY);
+        }
+        bGray = true;
+    }
+    return grayImg;
+}
+
+const vector<cv::Mat> &ImageCache::opticalFlowPyramid(int winSize, int maxLevel)
+{
+    if (pyramidMaxLevel != maxLevel || pyramidWinSize != winSize)
+    {
+        cv::buildOpticalFlowPyramid(gray(), pyramid, cv::Size(winSize, winSize), maxLevel);
+        pyramidWinSize = winSize;
+        pyramidMaxLevel = maxLevel;
+    }
+    return pyramid;
+}
@@ -0,0 +1,35 @@
+
+#ifndef imageCache_hpp
+#define imageCache_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+// images derived from the camera image of a frame, each built on first use and then shared by all stages, so that the
+// grayscale conversion and the pyramid are computed at most once per frame. Stages must not use the cache of a frame
+// concurrently, which the frame pipeline guarantees by handing a frame to one stage at a time.
+class ImageCache
+{
+public:
+    ImageCache() : bGray(false), pyramidWinSize(0), pyramidMaxLevel(-1) {}
+
+    // new camera image (shared, not copied); the derived images are invalidated, but their buffers are overwritten by the
+    // next build unless they are still referenced elsewhere (e.g. a pyramid kept by a tracker), then they are released
+    void reset(const cv::Mat &img);
+
+    const cv::Mat &color() const { return colorImg; }
+    const cv::Mat &gray(); // the camera image itself if it has a single channel
+
+    // cv::buildOpticalFlowPyramid of the grayscale image with derivatives, as used by cv::calcOpticalFlowPyrLK; rebuilt
+    // only if requested with other parameters
+    const std::vector<cv::Mat> &opticalFlowPyramid(int winSize, int maxLevel);
+
+private:
+    cv::Mat colorImg;
+    cv::Mat grayImg;
+    bool bGray;
+    std::vector<cv::Mat> pyramid;
+    int pyramidWinSize, pyramidMaxLevel; // parameters of pyramid, maxLevel -1 if it is not valid
+};
+
+#endif /* imageCache_hpp */
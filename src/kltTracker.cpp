@@ -0,0 +1,134 @@
+
+#include <stdexcept>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include "kltTracker.hpp"
+
+using namespace std;
+
+KltTracker::KltTracker(const KltTrackingOptions &options) : opts(options)
+{
+    if (opts.winSize < 3 || opts.maxLevel < 0 || opts.maxBackwardError < 0.0f)
+    {
+        throw invalid_argument("KltTracker: winSize must be at least 3, maxLevel and maxBackwardError must not be negative");
+    }
+}
+
+void KltTracker::track(const cv::Mat &imgGray, vector<cv::KeyPoint> &keypoints, vector<cv::DMatch> &matches)
+{
+    // the pyramid of the frame before the previous one is overwritten, unless it is shared with an image cache
+    for (auto it = currPyramid.begin(); it != currPyramid.end(); ++it)
+    {
+        if (it->u && it->u->refcount > 1)
+        {
+            it->release();
+        }
+    }
+    cv::buildOpticalFlowPyramid(imgGray, currPyramid, cv::Size(opts.winSize, opts.winSize), opts.maxLevel);
+    trackPyramids(imgGray.size(), keypoints, matches);
+}
+
+void KltTracker::track(const vector<cv::Mat> &pyramid, vector<cv::KeyPoint> &keypoints, vector<cv::DMatch> &matches)
+{
+    if (pyramid.empty())
+    {
+        throw invalid_argument("KltTracker: empty pyramid");
+    }
+    currPyramid = pyramid; // shares the images
+    trackPyramids(pyramid[0].size(), keypoints, matches);
+}
+
+void KltTracker::trackPyramids(cv::Size size, vector<cv::KeyPoint> &keypoints, vector<cv::DMatch> &matches)
+{
+    cv::Size winSize(opts.winSize, opts.winSize);
+    if (prevPyramid.empty() || prevKeypoints.empty() || size != imgSize)
+    {
+        imgSize = size;
+        return;
+    }
+
+    // forward pass, previous -> current frame
+    cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01);
+    cv::calcOpticalFlowPyrLK(prevPyramid, currPyramid, prevPoints, currPoints, status, errors, winSize, opts.maxLevel, criteria);
+
+    cv::Rect2f image(0.0f, 0.0f, imgSize.width, imgSize.height);
+    forwardIdx.clear();
+    forwardPoints.clear();
+    for (size_t i = 0; i < prevPoints.size(); ++i)
+    {
+        if (status[i] && image.contains(currPoints[i]))
+        {
+            forwardIdx.push_back(i);
+            forwardPoints.push_back(currPoints[i]);
+        }
+    }
+
+    // backward pass of the keypoints tracked forward, current -> previous frame, on the same pyramids
+    bool bCheck = opts.maxBackwardError > 0.0f && !forwardPoints.empty();
+    vector<uchar> backStatus;
+    if (bCheck)
+    {
+        vector<float> backErrors;
+        cv::calcOpticalFlowPyrLK(currPyramid, prevPyramid, forwardPoints, backPoints, backStatus, backErrors, winSize,
+                                 opts.maxLevel, criteria);
+    }
+
+    float maxErrorSq = opts.maxBackwardError * opts.maxBackwardError;
+    for (size_t k = 0; k < forwardIdx.size(); ++k)
+    {
+        int i = forwardIdx[k];
+        if (bCheck)
+        {
+            cv::Point2f d = backPoints[k] - prevPoints[i];
+            if (!backStatus[k] || d.x * d.x + d.y * d.y > maxErrorSq)
+            {
+                continue;
+            }
+        }
+        cv::KeyPoint kpt = prevKeypoints[i]; // size, angle and response stay those of the detection
+        kpt.pt = forwardPoints[k];
+        matches.push_back(cv::DMatch(i, keypoints.size(), errors[i]));
+        keypoints.push_back(kpt);
+    }
+}
+
+void KltTracker::addKeypoints(const vector<cv::KeyPoint> &detected, vector<cv::KeyPoint> &keypoints)
+{
+    if (keypoints.empty())
+    {
+        keypoints.insert(keypoints.end(), detected.begin(), detected.end());
+        return;
+    }
+
+    // discs around the keypoints in the list mark where no keypoint is added
+    occupied.create(imgSize, CV_8UC1);
+    occupied.setTo(cv::Scalar(0));
+    int radius = cvRound(opts.minDistance);
+    for (auto it = keypoints.begin(); it != keypoints.end(); ++it)
+    {
+        cv::circle(occupied, cv::Point(cvRound(it->pt.x), cvRound(it->pt.y)), radius, cv::Scalar(255), cv::FILLED);
+    }
+    for (auto it = detected.begin(); it != detected.end(); ++it)
+    {
+        cv::Point pt(cvRound(it->pt.x), cvRound(it->pt.y));
+        if (pt.x >= 0 && pt.y >= 0 && pt.x < occupied.cols && pt.y < occupied.rows && !occupied.at<uchar>(pt))
+        {
+            keypoints.push_back(*it);
+        }
+    }
+}
+
+void KltTracker::endFrame(const vector<cv::KeyPoint> &keypoints)
+{
+    prevKeypoints = keypoints;
+    cv::KeyPoint::convert(prevKeypoints, prevPoints);
+    swap(prevPyramid, currPyramid);
+}
+
+void KltTracker::reset()
+{
+    prevPyramid.clear();
+    prevKeypoints.clear();
+    prevPoints.clear();
+}
@@ -0,0 +1,66 @@
+
+#ifndef kltTracker_hpp
+#define kltTracker_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+// keypoint correspondences from pyramidal Lucas-Kanade optical flow instead of descriptor matching, see KltTracker
+struct KltTrackingOptions
+{
+    bool enabled;
+    int minTracked;         // keypoints are re-detected in a frame into which fewer keypoints were tracked
+    int winSize;            // [pixels] edge length of the search window on each pyramid level
+    int maxLevel;           // pyramid levels above the full resolution image
+    float maxBackwardError; // [pixels] a keypoint tracked back into the previous frame must end up this close to where it
+                            // started (forward-backward check), 0 disables the check
+    float minDistance;      // [pixels] re-detected keypoints closer than this to a tracked keypoint are dropped
+
+    KltTrackingOptions(bool enabled = false, int minTracked = 500, int winSize = 21, int maxLevel = 3,
+                       float maxBackwardError = 1.0f, float minDistance = 4.0f)
+        : enabled(enabled), minTracked(minTracked), winSize(winSize), maxLevel(maxLevel), maxBackwardError(maxBackwardError),
+          minDistance(minDistance) {}
+};
+
+// follows the keypoints of one frame into the next with cv::calcOpticalFlowPyrLK. The image pyramid of every frame is
+// built once and kept as the previous pyramid for the next frame, which the backward pass of the forward-backward check
+// uses as well. Frames must be passed in sequence order : track, optionally addKeypoints, then endFrame.
+class KltTracker
+{
+public:
+    explicit KltTracker(const KltTrackingOptions &options = KltTrackingOptions());
+
+    // builds the pyramid of imgGray and appends the keypoints of the previous frame which could be tracked into it, with
+    // their new position; matches are appended with queryIdx = keypoint of the previous frame and trainIdx = appended
+    // keypoint, and the tracking error as distance. Nothing is tracked into the first frame
+    void track(const cv::Mat &imgGray, std::vector<cv::KeyPoint> &keypoints, std::vector<cv::DMatch> &matches);
+    // same with the pyramid of the image, built by cv::buildOpticalFlowPyramid with winSize and maxLevel of the options
+    // (e.g. ImageCache::opticalFlowPyramid); the tracker keeps a reference to it until the frame after next
+    void track(const std::vector<cv::Mat> &pyramid, std::vector<cv::KeyPoint> &keypoints, std::vector<cv::DMatch> &matches);
+
+    // appends the detected keypoints which are at least minDistance away from all keypoints in the list
+    void addKeypoints(const std::vector<cv::KeyPoint> &detected, std::vector<cv::KeyPoint> &keypoints);
+
+    // the keypoints which are tracked into the next frame
+    void endFrame(const std::vector<cv::KeyPoint> &keypoints);
+
+    void reset(); // the next frame is treated as the first one
+
+    const KltTrackingOptions &options() const { return opts; }
+
+private:
+    void trackPyramids(cv::Size size, std::vector<cv::KeyPoint> &keypoints, std::vector<cv::DMatch> &matches);
+
+    KltTrackingOptions opts;
+    cv::Size imgSize;
+    std::vector<cv::Mat> prevPyramid, currPyramid;
+    std::vector<cv::KeyPoint> prevKeypoints;
+    std::vector<cv::Point2f> prevPoints, currPoints, backPoints; // scratch buffers of the forward and backward pass
+    std::vector<cv::Point2f> forwardPoints; // positions of the keypoints tracked forward, start of the backward pass
+    std::vector<int> forwardIdx;            // their index into prevKeypoints
+    std::vector<uchar> status;
+    std::vector<float> errors;
+    cv::Mat occupied; // scratch of addKeypoints
+};
+
+#endif /* kltTracker_hpp */
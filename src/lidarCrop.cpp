@@ -0,0 +1,256 @@
+
+#include <cmath>
+
+#include "lidarCrop.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define LIDAR_CROP_X86 1
+#endif
+
+using namespace std;
+
+static inline bool isInsideCropBox(float x, float y, float z, float r, const LidarCropBox &box)
+{
+    return x >= box.minX && x <= box.maxX && z >= box.minZ && z <= box.maxZ && z <= 0.0f && fabs(y) <= box.maxY && r >= box.minR;
+}
+
+// scalar crop of the points [i, n), survivors are moved to the front starting at nKept
+static size_t cropScalar(float *x, float *y, float *z, float *r, int *boxIDs, size_t i, size_t n, size_t nKept, const LidarCropBox &box)
+{
+    for (; i < n; ++i)
+    {
+        if (isInsideCropBox(x[i], y[i], z[i], r[i], box))
+        {
+            x[nKept] = x[i];
+            y[nKept] = y[i];
+            z[nKept] = z[i];
+            r[nKept] = r[i];
+            if (boxIDs)
+            {
+                boxIDs[nKept] = boxIDs[i];
+            }
+            ++nKept;
+        }
+    }
+    return nKept;
+}
+
+#ifdef LIDAR_CROP_X86
+
+// Both SIMD kernels evaluate the predicate over a whole block of points, turn the comparison result into a bit mask and
+// use it to look up a permutation which moves the surviving lanes to the front of the block. The permuted block is then
+// stored unaligned at the current output position. As the output never runs ahead of the input, such a store only
+// overwrites points which have already been loaded. All comparisons are ordered, so NaN fields are dropped like in the
+// scalar code.
+
+struct CompactionTables
+{
+    int avx2[256][8]; // lane permutation for _mm256_permutevar8x32_ps
+    unsigned char sse[16][16]; // byte shuffle for _mm_shuffle_epi8
+    int count[256]; // no. of set bits
+
+    CompactionTables()
+    {
+        for (int mask = 0; mask < 256; ++mask)
+        {
+            int n = 0;
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                if (mask & (1 << lane))
+                {
+                    avx2[mask][n++] = lane;
+                }
+            }
+            count[mask] = n;
+            for (int lane = n; lane < 8; ++lane)
+            {
+                avx2[mask][lane] = 0;
+            }
+        }
+
+        for (int mask = 0; mask < 16; ++mask)
+        {
+            int n = 0;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (mask & (1 << lane))
+                {
+                    for (int b = 0; b < 4; ++b)
+                    {
+                        sse[mask][4 * n + b] = (unsigned char)(4 * lane + b);
+                    }
+                    ++n;
+                }
+            }
+            for (int b = 4 * n; b < 16; ++b)
+            {
+                sse[mask][b] = 0x80; // zero the unused lanes
+            }
+        }
+    }
+};
+
+static const CompactionTables &compactionTables()
+{
+    static const CompactionTables tables;
+    return tables;
+}
+
+__attribute__((target("avx2")))
+static size_t cropAVX2(float *x, float *y, float *z, float *r, int *boxIDs, size_t n, const LidarCropBox &box)
+{
+    const CompactionTables &tables = compactionTables();
+    const __m256 minX = _mm256_set1_ps(box.minX), maxX = _mm256_set1_ps(box.maxX), maxY = _mm256_set1_ps(box.maxY);
+    const __m256 minZ = _mm256_set1_ps(box.minZ), maxZ = _mm256_set1_ps(box.maxZ), minR = _mm256_set1_ps(box.minR);
+    const __m256 zero = _mm256_setzero_ps(), signBit = _mm256_set1_ps(-0.0f);
+
+    size_t i = 0, nKept = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i), vr = _mm256_loadu_ps(r + i);
+
+        __m256 keep = _mm256_and_ps(_mm256_cmp_ps(vx, minX, _CMP_GE_OQ), _mm256_cmp_ps(vx, maxX, _CMP_LE_OQ));
+        keep = _mm256_and_ps(keep, _mm256_cmp_ps(vz, minZ, _CMP_GE_OQ));
+        keep = _mm256_and_ps(keep, _mm256_cmp_ps(vz, maxZ, _CMP_LE_OQ));
+        keep = _mm256_and_ps(keep, _mm256_cmp_ps(vz, zero, _CMP_LE_OQ));
+        keep = _mm256_and_ps(keep, _mm256_cmp_ps(_mm256_andnot_ps(signBit, vy), maxY, _CMP_LE_OQ));
+        keep = _mm256_and_ps(keep, _mm256_cmp_ps(vr, minR, _CMP_GE_OQ));
+
+        int mask = _mm256_movemask_ps(keep);
+        if (mask == 0)
+        {
+            continue;
+        }
+        if (mask == 0xFF && nKept == i) // whole block survives and is already in place
+        {
+            nKept += 8;
+            continue;
+        }
+
+        __m256i perm = _mm256_loadu_si256((const __m256i *)tables.avx2[mask]);
+        _mm256_storeu_ps(x + nKept, _mm256_permutevar8x32_ps(vx, perm));
+        _mm256_storeu_ps(y + nKept, _mm256_permutevar8x32_ps(vy, perm));
+        _mm256_storeu_ps(z + nKept, _mm256_permutevar8x32_ps(vz, perm));
+        _mm256_storeu_ps(r + nKept, _mm256_permutevar8x32_ps(vr, perm));
+        if (boxIDs)
+        {
+            __m256i ids = _mm256_loadu_si256((const __m256i *)(boxIDs + i));
+            _mm256_storeu_si256((__m256i *)(boxIDs + nKept), _mm256_permutevar8x32_epi32(ids, perm));
+        }
+        nKept += tables.count[mask];
+    }
+
+    return cropScalar(x, y, z, r, boxIDs, i, n, nKept, box);
+}
+
+__attribute__((target("ssse3")))
+static size_t cropSSE(float *x, float *y, float *z, float *r, int *boxIDs, size_t n, const LidarCropBox &box)
+{
+    const CompactionTables &tables = compactionTables();
+    const __m128 minX = _mm_set1_ps(box.minX), maxX = _mm_set1_ps(box.maxX), maxY = _mm_set1_ps(box.maxY);
+    const __m128 minZ = _mm_set1_ps(box.minZ), maxZ = _mm_set1_ps(box.maxZ), minR = _mm_set1_ps(box.minR);
+    const __m128 zero = _mm_setzero_ps(), signBit = _mm_set1_ps(-0.0f);
+
+    size_t i = 0, nKept = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i), vr = _mm_loadu_ps(r + i);
+
+        __m128 keep = _mm_and_ps(_mm_cmpge_ps(vx, minX), _mm_cmple_ps(vx, maxX));
+        keep = _mm_and_ps(keep, _mm_cmpge_ps(vz, minZ));
+        keep = _mm_and_ps(keep, _mm_cmple_ps(vz, maxZ));
+        keep = _mm_and_ps(keep, _mm_cmple_ps(vz, zero));
+        keep = _mm_and_ps(keep, _mm_cmple_ps(_mm_andnot_ps(signBit, vy), maxY));
+        keep = _mm_and_ps(keep, _mm_cmpge_ps(vr, minR));
+
+        int mask = _mm_movemask_ps(keep);
+        if (mask == 0)
+        {
+            continue;
+        }
+        if (mask == 0xF && nKept == i) // whole block survives and is already in place
+        {
+            nKept += 4;
+            continue;
+        }
+
+        __m128i shuffle = _mm_loadu_si128((const __m128i *)tables.sse[mask]);
+        _mm_storeu_ps(x + nKept, _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(vx), shuffle)));
+        _mm_storeu_ps(y + nKept, _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(vy), shuffle)));
+        _mm_storeu_ps(z + nKept, _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(vz), shuffle)));
+        _mm_storeu_ps(r + nKept, _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(vr), shuffle)));
+        if (boxIDs)
+        {
+            __m128i ids = _mm_loadu_si128((const __m128i *)(boxIDs + i));
+            _mm_storeu_si128((__m128i *)(boxIDs + nKept), _mm_shuffle_epi8(ids, shuffle));
+        }
+        nKept += tables.count[mask];
+    }
+
+    return cropScalar(x, y, z, r, boxIDs, i, n, nKept, box);
+}
+
+#endif /* LIDAR_CROP_X86 */
+
+bool isCropKernelSupported(CropKernel kernel)
+{
+    switch (kernel)
+    {
+    case CropKernel::Auto:
+    case CropKernel::Scalar:
+        return true;
+#ifdef LIDAR_CROP_X86
+    case CropKernel::SSE:
+        return __builtin_cpu_supports("ssse3");
+    case CropKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+CropKernel bestCropKernel()
+{
+    static const CropKernel best = isCropKernelSupported(CropKernel::AVX2) ? CropKernel::AVX2
+                                 : isCropKernelSupported(CropKernel::SSE) ? CropKernel::SSE
+                                 : CropKernel::Scalar;
+    return best;
+}
+
+const char *cropKernelName(CropKernel kernel)
+{
+    switch (kernel)
+    {
+    case CropKernel::Auto:
+        return cropKernelName(bestCropKernel());
+    case CropKernel::Scalar:
+        return "scalar";
+    case CropKernel::SSE:
+        return "SSE";
+    case CropKernel::AVX2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+
+size_t cropLidarArrays(float *x, float *y, float *z, float *r, int *boxIDs, size_t n, const LidarCropBox &box, CropKernel kernel)
+{
+    if (kernel == CropKernel::Auto || !isCropKernelSupported(kernel))
+    {
+        kernel = bestCropKernel();
+    }
+
+#ifdef LIDAR_CROP_X86
+    if (kernel == CropKernel::AVX2)
+    {
+        return cropAVX2(x, y, z, r, boxIDs, n, box);
+    }
+    if (kernel == CropKernel::SSE)
+    {
+        return cropSSE(x, y, z, r, boxIDs, n, box);
+    }
+#endif
+    return cropScalar(x, y, z, r, boxIDs, 0, n, 0, box);
+}
@@ -0,0 +1,22 @@
+
+#ifndef lidarCrop_hpp
+#define lidarCrop_hpp
+
+#include <cstddef>
+
+// instruction set used by the Lidar crop kernel, Auto picks the widest one supported by the CPU at runtime
+enum class CropKernel { Auto, Scalar, SSE, AVX2 };
+
+struct LidarCropBox { // points are kept if minX <= x <= maxX, |y| <= maxY, minZ <= z <= min(maxZ, 0) and r >= minR
+    float minX, maxX, maxY, minZ, maxZ, minR;
+};
+
+// removes all points outside the crop box from the field arrays in place and returns the no. of remaining points;
+// boxIDs may be nullptr, all kernels keep the surviving points in their original order and give identical results
+size_t cropLidarArrays(float *x, float *y, float *z, float *r, int *boxIDs, size_t n, const LidarCropBox &box, CropKernel kernel=CropKernel::Auto);
+
+bool isCropKernelSupported(CropKernel kernel);
+CropKernel bestCropKernel();
+const char *cropKernelName(CropKernel kernel);
+
+#endif /* lidarCrop_hpp */
@@ -9,60 +9,140 @@
 using namespace std;
 
 // remove Lidar points based on min. and max distance in X, Y and Z
+void cropLidarPoints(LidarCloud &lidarPoints, float minX, float maxX, float maxY, float minZ, float maxZ, float minR, CropKernel kernel)
+{
+    // survivors are compacted towards the front of each array by the fastest kernel the CPU supports
+    LidarCropBox box = {minX, maxX, maxY, minZ, maxZ, minR};
+    int *boxIDs = lidarPoints.hasBoxIDs() ? lidarPoints.boxIDs.data() : nullptr;
+    size_t nKept = cropLidarArrays(lidarPoints.x.data(), lidarPoints.y.data(), lidarPoints.z.data(), lidarPoints.r.data(),
+                                   boxIDs, lidarPoints.size(), box, kernel);
+
+    lidarPoints.resize(nKept);
+    if (boxIDs)
+    {
+        lidarPoints.boxIDs.resize(nKept);
+    }
+}
+
 void cropLidarPoints(std::vector<LidarPoint> &lidarPoints, float minX, float maxX, float maxY, float minZ, float maxZ, float minR)
 {
-    std::vector<LidarPoint> newLidarPts; 
-    for(auto it=lidarPoints.begin(); it!=lidarPoints.end(); ++it) {
-        
-       if( (*it).x>=minX && (*it).x<=maxX && (*it).z>=minZ && (*it).z<=maxZ && (*it).z<=0.0 && abs((*it).y)<=maxY && (*it).r>=minR )  // Check if Lidar point is outside of boundaries
-       {
-           newLidarPts.push_back(*it);
-       }
+    // compact the surviving points in place instead of copying them into a new vector
+    size_t nKept = 0;
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
+    {
+        const LidarPoint &pt = lidarPoints[i];
+        if (pt.x >= minX && pt.x <= maxX && pt.z >= minZ && pt.z <= maxZ && pt.z <= 0.0 && abs(pt.y) <= maxY && pt.r >= minR) // Check if Lidar point is outside of boundaries
+        {
+            lidarPoints[nKept++] = pt;
+        }
     }
+    lidarPoints.resize(nKept);
+}
+
 
-    lidarPoints = newLidarPts;
+
+bool LidarScan::open(const std::string &filename)
+{
+    count = 0;
+    if (!file.open(filename))
+    {
+        cout << "Lidar scan " << filename << " could not be opened" << endl;
+        return false;
+    }
+
+    count = file.size() / sizeof(LidarRecord);
+    if (file.size() % sizeof(LidarRecord) != 0)
+    {
+        cout << "Lidar scan " << filename << " is truncated, ignoring the last " << file.size() % sizeof(LidarRecord) << " bytes" << endl;
+    }
+    return true;
 }
 
+// Load Lidar points from a given location and store them in separate arrays per field
+void loadLidarFromFile(LidarCloud &lidarPoints, string filename)
+{
+    LidarScan scan(filename);
 
+    size_t offset = lidarPoints.size();
+    lidarPoints.resize(offset + scan.size());
+    lidarPoints.boxIDs.clear();
+    for (size_t i = 0; i < scan.size(); ++i)
+    {
+        lidarPoints.x[offset + i] = scan[i].x;
+        lidarPoints.y[offset + i] = scan[i].y;
+        lidarPoints.z[offset + i] = scan[i].z;
+        lidarPoints.r[offset + i] = scan[i].r;
+    }
+}
 
 // Load Lidar points from a given location and store them in a vector
 void loadLidarFromFile(vector<LidarPoint> &lidarPoints, string filename)
 {
-    // allocate 4 MB buffer (only ~130*4*4 KB are needed)
-    unsigned long num = 1000000;
-    float *data = (float*)malloc(num*sizeof(float));
-    
-    // pointers
-    float *px = data+0;
-    float *py = data+1;
-    float *pz = data+2;
-    float *pr = data+3;
-    
-    // load point cloud
-    FILE *stream;
-    stream = fopen (filename.c_str(),"rb");
-    num = fread(data,sizeof(float),num,stream)/4;
- 
-    for (int32_t i=0; i<num; i++) {
+    LidarScan scan(filename);
+
+    // size the cloud from the file length, the conversion to double happens only here
+    lidarPoints.reserve(lidarPoints.size() + scan.size());
+    for (auto it = scan.begin(); it != scan.end(); ++it)
+    {
         LidarPoint lpt;
-        lpt.x = *px; lpt.y = *py; lpt.z = *pz; lpt.r = *pr;
+        lpt.x = it->x; lpt.y = it->y; lpt.z = it->z; lpt.r = it->r;
         lidarPoints.push_back(lpt);
-        px+=4; py+=4; pz+=4; pr+=4;
     }
-    fclose(stream);
 }
 
 
-void showLidarTopview(std::vector<LidarPoint> &lidarPoints, cv::Size worldSize, cv::Size imageSize, bool bWait)
+void toLidarCloud(const std::vector<LidarPoint> &lidarPoints, LidarCloud &lidarCloud)
+{
+    lidarCloud.clear();
+    lidarCloud.reserve(lidarPoints.size());
+    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    {
+        lidarCloud.push_back(*it);
+    }
+}
+
+void toLidarPoints(const LidarCloud &lidarCloud, std::vector<LidarPoint> &lidarPoints)
+{
+    lidarPoints.resize(lidarCloud.size());
+    for (size_t i = 0; i < lidarCloud.size(); ++i)
+    {
+        lidarPoints[i] = lidarCloud.point(i);
+    }
+}
+
+
+void loadKittiCalibration(cv::Mat &P_rect_00, cv::Mat &R_rect_00, cv::Mat &RT)
+{
+    P_rect_00.create(3,4,cv::DataType<double>::type); // 3x4 projection matrix after rectification
+    R_rect_00.create(4,4,cv::DataType<double>::type); // 3x3 rectifying rotation to make image planes co-planar
+    RT.create(4,4,cv::DataType<double>::type); // rotation matrix and translation vector
+    
+    RT.at<double>(0,0) = 7.533745e-03; RT.at<double>(0,1) = -9.999714e-01; RT.at<double>(0,2) = -6.166020e-04; RT.at<double>(0,3) = -4.069766e-03;
+    RT.at<double>(1,0) = 1.480249e-02; RT.at<double>(1,1) = 7.280733e-04; RT.at<double>(1,2) = -9.998902e-01; RT.at<double>(1,3) = -7.631618e-02;
+    RT.at<double>(2,0) = 9.998621e-01; RT.at<double>(2,1) = 7.523790e-03; RT.at<double>(2,2) = 1.480755e-02; RT.at<double>(2,3) = -2.717806e-01;
+    RT.at<double>(3,0) = 0.0; RT.at<double>(3,1) = 0.0; RT.at<double>(3,2) = 0.0; RT.at<double>(3,3) = 1.0;
+    
+    R_rect_00.at<double>(0,0) = 9.999239e-01; R_rect_00.at<double>(0,1) = 9.837760e-03; R_rect_00.at<double>(0,2) = -7.445048e-03; R_rect_00.at<double>(0,3) = 0.0;
+    R_rect_00.at<double>(1,0) = -9.869795e-03; R_rect_00.at<double>(1,1) = 9.999421e-01; R_rect_00.at<double>(1,2) = -4.278459e-03; R_rect_00.at<double>(1,3) = 0.0;
+    R_rect_00.at<double>(2,0) = 7.402527e-03; R_rect_00.at<double>(2,1) = 4.351614e-03; R_rect_00.at<double>(2,2) = 9.999631e-01; R_rect_00.at<double>(2,3) = 0.0;
+    R_rect_00.at<double>(3,0) = 0; R_rect_00.at<double>(3,1) = 0; R_rect_00.at<double>(3,2) = 0; R_rect_00.at<double>(3,3) = 1;
+    
+    P_rect_00.at<double>(0,0) = 7.215377e+02; P_rect_00.at<double>(0,1) = 0.000000e+00; P_rect_00.at<double>(0,2) = 6.095593e+02; P_rect_00.at<double>(0,3) = 0.000000e+00;
+    P_rect_00.at<double>(1,0) = 0.000000e+00; P_rect_00.at<double>(1,1) = 7.215377e+02; P_rect_00.at<double>(1,2) = 1.728540e+02; P_rect_00.at<double>(1,3) = 0.000000e+00;
+    P_rect_00.at<double>(2,0) = 0.000000e+00; P_rect_00.at<double>(2,1) = 0.000000e+00; P_rect_00.at<double>(2,2) = 1.000000e+00; P_rect_00.at<double>(2,3) = 0.000000e+00;    
+}
+
+
+void showLidarTopview(const LidarCloud &lidarPoints, cv::Size worldSize, cv::Size imageSize, bool bWait)
 {
     // create topview image
     cv::Mat topviewImg(imageSize, CV_8UC3, cv::Scalar(0, 0, 0));
 
     // plot Lidar points into image
-    for (auto it = lidarPoints.begin(); it != lidarPoints.end(); ++it)
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
     {
-        float xw = (*it).x; // world position in m with x facing forward from sensor
-        float yw = (*it).y; // world position in m with y facing left from sensor
+        float xw = lidarPoints.x[i]; // world position in m with x facing forward from sensor
+        float yw = lidarPoints.y[i]; // world position in m with y facing left from sensor
 
         int y = (-xw * imageSize.height / worldSize.height) + imageSize.height;
         int x = (-yw * imageSize.height / worldSize.height) + imageSize.width / 2;
@@ -89,7 +169,14 @@ void showLidarTopview(std::vector<LidarPoint> &lidarPoints, cv::Size worldSize,
     }
 }
 
-void showLidarImgOverlay(cv::Mat &img, std::vector<LidarPoint> &lidarPoints, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT, cv::Mat *extVisImg)
+void showLidarTopview(std::vector<LidarPoint> &lidarPoints, cv::Size worldSize, cv::Size imageSize, bool bWait)
+{
+    LidarCloud lidarCloud;
+    toLidarCloud(lidarPoints, lidarCloud);
+    showLidarTopview(lidarCloud, worldSize, imageSize, bWait);
+}
+
+void showLidarImgOverlay(cv::Mat &img, const LidarCloud &lidarPoints, const LidarProjector &projector, cv::Mat *extVisImg)
 {
     // init image for visualization
     cv::Mat visImg; 
@@ -105,26 +192,24 @@ void showLidarImgOverlay(cv::Mat &img, std::vector<LidarPoint> &lidarPoints, cv:
 
     // find max. x-value
     double maxVal = 0.0; 
-    for(auto it=lidarPoints.begin(); it!=lidarPoints.end(); ++it)
+    for (size_t i = 0; i < lidarPoints.size(); ++i)
     {
-        maxVal = maxVal<it->x ? it->x : maxVal;
+        maxVal = maxVal<lidarPoints.x[i] ? lidarPoints.x[i] : maxVal;
     }
 
-    cv::Mat X(4,1,cv::DataType<double>::type);
-    cv::Mat Y(3,1,cv::DataType<double>::type);
-    for(auto it=lidarPoints.begin(); it!=lidarPoints.end(); ++it) {
-
-            X.at<double>(0, 0) = it->x;
-            X.at<double>(1, 0) = it->y;
-            X.at<double>(2, 0) = it->z;
-            X.at<double>(3, 0) = 1;
+    LidarProjection projection;
+    projector.project(lidarPoints, projection);
+    for (size_t i = 0; i < lidarPoints.size(); ++i) {
 
-            Y = P_rect_xx * R_rect_xx * RT * X;
+            if (!projection.valid[i]) // point is behind the camera
+            {
+                continue;
+            }
             cv::Point pt;
-            pt.x = Y.at<double>(0, 0) / Y.at<double>(0, 2);
-            pt.y = Y.at<double>(1, 0) / Y.at<double>(0, 2);
+            pt.x = projection.u[i];
+            pt.y = projection.v[i];
 
-            float val = it->x;
+            float val = lidarPoints.x[i];
             int red = min(255, (int)(255 * abs((val - maxVal) / maxVal)));
             int green = min(255, (int)(255 * (1 - abs((val - maxVal) / maxVal))));
             cv::circle(overlay, pt, 5, cv::Scalar(0, green, red), -1);
@@ -145,4 +230,16 @@ void showLidarImgOverlay(cv::Mat &img, std::vector<LidarPoint> &lidarPoints, cv:
     {
         extVisImg = &visImg;
     }
-}
\ No newline at end of file
+}
+
+void showLidarImgOverlay(cv::Mat &img, const LidarCloud &lidarPoints, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT, cv::Mat *extVisImg)
+{
+    showLidarImgOverlay(img, lidarPoints, LidarProjector(P_rect_xx, R_rect_xx, RT), extVisImg);
+}
+
+void showLidarImgOverlay(cv::Mat &img, std::vector<LidarPoint> &lidarPoints, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT, cv::Mat *extVisImg)
+{
+    LidarCloud lidarCloud;
+    toLidarCloud(lidarPoints, lidarCloud);
+    showLidarImgOverlay(img, lidarCloud, P_rect_xx, R_rect_xx, RT, extVisImg);
+}
@@ -7,10 +7,48 @@
 #include <string>
 
 #include "dataStructures.h"
+#include "mappedFile.hpp"
+#include "lidarCrop.hpp"
+#include "lidarProjection.hpp"
 
+// read-only view of a KITTI Velodyne scan; the file is memory-mapped and its float records are exposed without copying
+class LidarScan
+{
+public:
+    LidarScan() : count(0) {}
+    explicit LidarScan(const std::string &filename) : count(0) { open(filename); }
+
+    // returns false if the file is missing; incomplete records at the end of a truncated file are ignored
+    bool open(const std::string &filename);
+
+    const LidarRecord *begin() const { return (const LidarRecord *)file.data(); }
+    const LidarRecord *end() const { return begin() + count; }
+    const LidarRecord &operator[](size_t i) const { return begin()[i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    MappedFile file;
+    size_t count; // no. of complete records in the file
+};
+
+void cropLidarPoints(LidarCloud &lidarPoints, float minX, float maxX, float maxY, float minZ, float maxZ, float minR, CropKernel kernel=CropKernel::Auto);
+void loadLidarFromFile(LidarCloud &lidarPoints, std::string filename);
+
+void showLidarTopview(const LidarCloud &lidarPoints, cv::Size worldSize, cv::Size imageSize, bool bWait=true);
+void showLidarImgOverlay(cv::Mat &img, const LidarCloud &lidarPoints, const LidarProjector &projector, cv::Mat *extVisImg=nullptr);
+void showLidarImgOverlay(cv::Mat &img, const LidarCloud &lidarPoints, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT, cv::Mat *extVisImg=nullptr);
+
+// calibration of camera and Lidar for the KITTI sequence 2011_09_26
+void loadKittiCalibration(cv::Mat &P_rect_00, cv::Mat &R_rect_00, cv::Mat &RT);
+
+// adapters between the array-of-structs and the structure-of-arrays representation
+void toLidarCloud(const std::vector<LidarPoint> &lidarPoints, LidarCloud &lidarCloud);
+void toLidarPoints(const LidarCloud &lidarCloud, std::vector<LidarPoint> &lidarPoints);
+
+// std::vector<LidarPoint> versions of the functions above
 void cropLidarPoints(std::vector<LidarPoint> &lidarPoints, float minX, float maxX, float maxY, float minZ, float maxZ, float minR);
 void loadLidarFromFile(std::vector<LidarPoint> &lidarPoints, std::string filename);
-
 void showLidarTopview(std::vector<LidarPoint> &lidarPoints, cv::Size worldSize, cv::Size imageSize, bool bWait=true);
 void showLidarImgOverlay(cv::Mat &img, std::vector<LidarPoint> &lidarPoints, cv::Mat &P_rect_xx, cv::Mat &R_rect_xx, cv::Mat &RT, cv::Mat *extVisImg=nullptr);
 #endif /* lidarData_hpp */
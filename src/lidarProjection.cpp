@@ -0,0 +1,60 @@
+
+#include "lidarProjection.hpp"
+
+using namespace std;
+
+LidarProjector::LidarProjector()
+{
+    for (int i = 0; i < 12; ++i)
+    {
+        M[i] = (i % 5 == 0) ? 1.0 : 0.0; // [I | 0]
+    }
+}
+
+LidarProjector::LidarProjector(const cv::Mat &P_rect_xx, const cv::Mat &R_rect_xx, const cv::Mat &RT)
+{
+    setCalibration(P_rect_xx, R_rect_xx, RT);
+}
+
+void LidarProjector::setCalibration(const cv::Mat &P_rect_xx, const cv::Mat &R_rect_xx, const cv::Mat &RT)
+{
+    // same association as the per-point product P_rect_xx * R_rect_xx * RT * X
+    cv::Mat PRT = P_rect_xx * R_rect_xx * RT;
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            M[4 * r + c] = PRT.at<double>(r, c);
+        }
+    }
+}
+
+void LidarProjector::project(const LidarCloud &lidarPoints, LidarProjection &projection) const
+{
+    size_t n = lidarPoints.size();
+    projection.u.resize(n);
+    projection.v.resize(n);
+    projection.valid.resize(n);
+
+    // branch-free loop over contiguous arrays so that the compiler can vectorize it
+    const float *px = lidarPoints.x.data(), *py = lidarPoints.y.data(), *pz = lidarPoints.z.data();
+    float *pu = projection.u.data(), *pv = projection.v.data();
+    unsigned char *pValid = projection.valid.data();
+    const double m00 = M[0], m01 = M[1], m02 = M[2], m03 = M[3];
+    const double m10 = M[4], m11 = M[5], m12 = M[6], m13 = M[7];
+    const double m20 = M[8], m21 = M[9], m22 = M[10], m23 = M[11];
+    for (size_t i = 0; i < n; ++i)
+    {
+        double x = px[i], y = py[i], z = pz[i];
+        double w = m20 * x + m21 * y + m22 * z + m23;
+        pu[i] = (float)((m00 * x + m01 * y + m02 * z + m03) / w);
+        pv[i] = (float)((m10 * x + m11 * y + m12 * z + m13) / w);
+        pValid[i] = w > 0.0;
+    }
+}
+
+cv::Point2d LidarProjector::project(double x, double y, double z) const
+{
+    double w = M[8] * x + M[9] * y + M[10] * z + M[11];
+    return cv::Point2d((M[0] * x + M[1] * y + M[2] * z + M[3]) / w, (M[4] * x + M[5] * y + M[6] * z + M[7]) / w);
+}
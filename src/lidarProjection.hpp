@@ -0,0 +1,36 @@
+
+#ifndef lidarProjection_hpp
+#define lidarProjection_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+struct LidarProjection { // image positions of a whole Lidar cloud, one entry per point
+    std::vector<float> u, v; // pixel coordinates
+    std::vector<unsigned char> valid; // 0 for points behind the camera, their u and v are meaningless
+
+    size_t size() const { return u.size(); }
+};
+
+// projects Lidar points into the camera image; P_rect_xx * R_rect_xx * RT is folded into a single 3x4 matrix once
+class LidarProjector
+{
+public:
+    LidarProjector();
+    LidarProjector(const cv::Mat &P_rect_xx, const cv::Mat &R_rect_xx, const cv::Mat &RT);
+
+    void setCalibration(const cv::Mat &P_rect_xx, const cv::Mat &R_rect_xx, const cv::Mat &RT);
+
+    // projects all points in one pass over the field arrays, projection is resized to the size of the cloud
+    void project(const LidarCloud &lidarPoints, LidarProjection &projection) const;
+    cv::Point2d project(double x, double y, double z) const;
+
+    const double *matrix() const { return M; } // row-major 3x4
+
+private:
+    double M[12];
+};
+
+#endif /* lidarProjection_hpp */
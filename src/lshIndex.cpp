@@ -0,0 +1,161 @@
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "lshIndex.hpp"
+#include "hammingMatcher.hpp"
+
+using namespace std;
+
+LshIndex::LshIndex(const LshOptions &options) : options(options)
+{
+    if (options.nTables < 1 || options.keyBits < 1 || options.keyBits > 24)
+    {
+        throw invalid_argument("LshIndex: nTables must be positive and keyBits between 1 and 24");
+    }
+}
+
+int LshIndex::hashKey(const uchar *descriptor, int table) const
+{
+    const int *positions = &bitPositions[table * options.keyBits];
+    int key = 0;
+    for (int b = 0; b < options.keyBits; ++b)
+    {
+        key |= ((descriptor[positions[b] >> 3] >> (positions[b] & 7)) & 1) << b;
+    }
+    return key;
+}
+
+void LshIndex::build(const cv::Mat &descriptors)
+{
+    if (!descriptors.empty() && descriptors.type() != CV_8U)
+    {
+        throw invalid_argument("LshIndex: descriptors must be binary");
+    }
+
+    // the sampled bits only depend on the descriptor width, which is the same for all frames of a sequence
+    int nBits = 8 * descriptors.cols;
+    if (bitPositions.empty() || nBits != 8 * train.cols)
+    {
+        mt19937 rng(options.seed);
+        vector<int> allBits(nBits);
+        for (int b = 0; b < nBits; ++b)
+        {
+            allBits[b] = b;
+        }
+        bitPositions.clear();
+        for (int t = 0; t < options.nTables; ++t)
+        { // distinct bits within each table
+            shuffle(allBits.begin(), allBits.end(), rng);
+            bitPositions.insert(bitPositions.end(), allBits.begin(), allBits.begin() + min(options.keyBits, nBits));
+        }
+        bitPositions.resize(options.nTables * options.keyBits, 0);
+    }
+    train = descriptors;
+
+    // counting sort of the descriptor indices by bucket, one table after the other
+    int nBuckets = 1 << options.keyBits, n = train.rows;
+    bucketStart.assign(options.nTables * (nBuckets + 1), 0);
+    entries.resize(options.nTables * n);
+    keys.resize(n);
+    for (int t = 0; t < options.nTables; ++t)
+    {
+        int *start = &bucketStart[t * (nBuckets + 1)];
+        for (int i = 0; i < n; ++i)
+        {
+            keys[i] = hashKey(train.ptr<uchar>(i), t);
+            ++start[keys[i] + 1];
+        }
+        for (int k = 0; k < nBuckets; ++k)
+        {
+            start[k + 1] += start[k];
+        }
+        int *tableEntries = &entries[t * n];
+        for (int i = 0; i < n; ++i)
+        {
+            tableEntries[start[keys[i]]++] = i;
+        }
+        for (int k = nBuckets; k > 0; --k) // undo the increments of the fill pass
+        {
+            start[k] = start[k - 1];
+        }
+        start[0] = 0;
+    }
+}
+
+void LshIndex::matchRows(const cv::Mat &descQuery, int rowBegin, int rowEnd, double minDescDistRatio, vector<int> &candidates,
+                         vector<cv::DMatch> &rowMatches) const
+{
+    int nBuckets = 1 << options.keyBits, n = train.rows;
+    for (int i = rowBegin; i < rowEnd; ++i)
+    {
+        const uchar *query = descQuery.ptr<uchar>(i);
+        candidates.clear();
+        for (int t = 0; t < options.nTables; ++t)
+        {
+            const int *start = &bucketStart[t * (nBuckets + 1)];
+            const int *tableEntries = &entries[t * n];
+            int key = hashKey(query, t);
+            for (int probe = -1; probe < (options.bMultiProbe ? options.keyBits : 0); ++probe)
+            {
+                int bucket = probe < 0 ? key : key ^ (1 << probe);
+                candidates.insert(candidates.end(), tableEntries + start[bucket], tableEntries + start[bucket + 1]);
+            }
+        }
+        sort(candidates.begin(), candidates.end());
+        candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // a query without a candidate, or with a single one when the ratio test needs a second neighbour, is compared
+        // against all descriptors, so that the result does not depend on the bucketing
+        bool bRatioTest = !std::isinf(minDescDistRatio);
+        bool bFullScan = candidates.size() < (bRatioTest ? 2u : 1u);
+        HammingBestTwo result = bFullScan ? hammingBestTwo(query, train)
+                                          : hammingBestTwo(query, train, candidates.data(), candidates.size());
+        bool bMatch = result.bestIdx >= 0 &&
+                      (!bRatioTest || (result.second != numeric_limits<int>::max() && result.best < minDescDistRatio * result.second));
+        rowMatches.push_back(bMatch ? cv::DMatch(i, result.bestIdx, (float)result.best) : cv::DMatch(-1, -1, 0.0f));
+    }
+}
+
+void LshIndex::match(const cv::Mat &descQuery, vector<cv::DMatch> &matches, double minDescDistRatio, ThreadPool *pool)
+{
+    if (descQuery.empty() || train.empty())
+    {
+        return;
+    }
+    if (descQuery.type() != CV_8U || descQuery.cols != train.cols)
+    {
+        throw invalid_argument("LshIndex: query descriptors must be binary and as wide as the indexed ones");
+    }
+
+    rowMatches.clear();
+    if (!pool || pool->size() == 1)
+    {
+        matchRows(descQuery, 0, descQuery.rows, minDescDistRatio, candidateScratch, rowMatches);
+    }
+    else
+    {
+        // blocks of query rows, each block writes its own range of slots so that the order of the matches is preserved
+        rowMatches.resize(descQuery.rows);
+        const int blockSize = 64;
+        int nBlocks = (descQuery.rows + blockSize - 1) / blockSize;
+        pool->parallelFor(nBlocks, [&](size_t block) {
+            int rowBegin = block * blockSize, rowEnd = min(descQuery.rows, rowBegin + blockSize);
+            vector<int> candidates;
+            vector<cv::DMatch> blockMatches;
+            matchRows(descQuery, rowBegin, rowEnd, minDescDistRatio, candidates, blockMatches);
+            copy(blockMatches.begin(), blockMatches.end(), rowMatches.begin() + rowBegin);
+        });
+    }
+
+    for (auto it = rowMatches.begin(); it != rowMatches.end(); ++it)
+    {
+        if (it->queryIdx >= 0)
+        {
+            matches.push_back(*it);
+        }
+    }
+}
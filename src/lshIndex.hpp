@@ -0,0 +1,54 @@
+
+#ifndef lshIndex_hpp
+#define lshIndex_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "threadPool.hpp"
+
+struct LshOptions
+{
+    int nTables;   // independent hash tables, more tables raise the recall and the query time
+    int keyBits;   // descriptor bits sampled per table, the table has 2^keyBits buckets
+    bool bMultiProbe; // also probe the keyBits buckets whose key differs in one bit
+    unsigned int seed; // random choice of the sampled bits, so that results are reproducible
+
+    LshOptions(int nTables = 6, int keyBits = 12, bool bMultiProbe = true, unsigned int seed = 1)
+        : nTables(nTables), keyBits(keyBits), bMultiProbe(bMultiProbe), seed(seed) {}
+};
+
+// locality sensitive hashing index over binary descriptors (bit sampling, Hamming distance), built once per frame.
+// Queries only compute the distance to descriptors sharing a bucket with them, so the best and second best match are
+// approximate : a match may be missed, and the ratio test sees the second best candidate instead of the second best
+// descriptor. A query without candidates, or with a single one when the ratio test is active, is compared against all
+// descriptors, so that no query is passed without a second neighbour and the result does not depend on the threads. The indexed descriptors are referenced, not copied or converted, and must stay alive until the next build.
+class LshIndex
+{
+public:
+    explicit LshIndex(const LshOptions &options = LshOptions());
+
+    void build(const cv::Mat &descriptors);
+
+    // appends a match for every query whose best candidate distance is below minDescDistRatio times the second best one
+    // (pass infinity to keep the best candidate of every query); with a pool, blocks of query rows run in parallel
+    void match(const cv::Mat &descQuery, std::vector<cv::DMatch> &matches, double minDescDistRatio, ThreadPool *pool = nullptr);
+
+    size_t size() const { return train.rows; }
+
+private:
+    int hashKey(const uchar *descriptor, int table) const;
+    void matchRows(const cv::Mat &descQuery, int rowBegin, int rowEnd, double minDescDistRatio, std::vector<int> &candidates,
+                   std::vector<cv::DMatch> &rowMatches) const;
+
+    LshOptions options;
+    cv::Mat train;
+    std::vector<int> bitPositions;  // keyBits sampled bit positions per table
+    std::vector<int> bucketStart;   // per table 2^keyBits + 1 offsets into entries (CSR layout)
+    std::vector<int> entries;       // per table the descriptor indices sorted by bucket
+    std::vector<int> keys;          // scratch : key of each descriptor while building
+    std::vector<int> candidateScratch;
+    std::vector<cv::DMatch> rowMatches; // one entry per query row in parallel mode, queryIdx < 0 if the row has no match
+};
+
+#endif /* lshIndex_hpp */
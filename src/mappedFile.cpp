@@ -0,0 +1,119 @@
+
+#include <fstream>
+#include <utility>
+
+#include "mappedFile.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define MAPPED_FILE_HAVE_MMAP 1
+#endif
+
+using namespace std;
+
+MappedFile::MappedFile() : ptr(nullptr), length(0), bOpen(false), bMapped(false) {}
+
+MappedFile::MappedFile(const std::string &filename) : MappedFile()
+{
+    open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) : MappedFile()
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other)
+{
+    if (this != &other)
+    {
+        close();
+        ptr = other.ptr;
+        length = other.length;
+        bOpen = other.bOpen;
+        bMapped = other.bMapped;
+        buffer.swap(other.buffer);
+        other.ptr = nullptr;
+        other.length = 0;
+        other.bOpen = false;
+        other.bMapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+
+#ifdef MAPPED_FILE_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    length = (size_t)fileStat.st_size;
+    if (length > 0) // mapping an empty file is not allowed, it is reported as an open file of size 0
+    {
+        void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        ptr = (const char *)mapping;
+        bMapped = true;
+    }
+    ::close(fd); // the mapping stays valid after closing the descriptor
+#else
+    ifstream ifs(filename.c_str(), ios::binary | ios::ate);
+    if (!ifs)
+    {
+        return false;
+    }
+    buffer.resize((size_t)ifs.tellg());
+    ifs.seekg(0);
+    if (!buffer.empty() && !ifs.read(&buffer[0], buffer.size()))
+    {
+        buffer.clear();
+        return false;
+    }
+    ptr = buffer.empty() ? nullptr : &buffer[0];
+    length = buffer.size();
+#endif
+
+    bOpen = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef MAPPED_FILE_HAVE_MMAP
+    if (bMapped)
+    {
+        munmap((void *)ptr, length);
+    }
+#endif
+    buffer.clear();
+    ptr = nullptr;
+    length = 0;
+    bOpen = false;
+    bMapped = false;
+}
@@ -0,0 +1,37 @@
+
+#ifndef mappedFile_hpp
+#define mappedFile_hpp
+
+#include <string>
+#include <vector>
+
+// read-only memory mapping of a whole file; on platforms without mmap the file is read into memory instead
+class MappedFile
+{
+public:
+    MappedFile();
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other);
+    MappedFile &operator=(MappedFile &&other);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // returns false if the file does not exist or cannot be mapped
+    bool open(const std::string &filename);
+    void close();
+
+    bool isOpen() const { return bOpen; }
+    const char *data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    const char *ptr;
+    size_t length;
+    bool bOpen;
+    bool bMapped;              // ptr points to a mapping which has to be released with munmap
+    std::vector<char> buffer;  // file contents if mmap is not available
+};
+
+#endif /* mappedFile_hpp */
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <numeric>
 #include "matching2D.hpp"
 
@@ -11,6 +12,7 @@ void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::Key
     // configure matcher
     bool crossCheck = false;
     cv::Ptr<cv::DescriptorMatcher> matcher;
+    cv::Mat source = descSource, ref = descRef; // share the descriptors of the caller unless they have to be converted
 
     if (matcherType.compare("MAT_BF") == 0)
     {
@@ -22,8 +24,9 @@ void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::Key
         // ... TASK MP.5 - Implement FLANN Matching - Student Code //
         if (descSource.type()!= CV_32F || descRef.type()!= CV_32F)
         {
-            descSource.convertTo(descSource, CV_32F);   // this is a opencv bug, convert binary descriptors to float //
-            descRef.convertTo(descRef, CV_32F);
+            // this is a opencv bug, convert binary descriptors to float; copies, so that the frame buffer keeps the originals //
+            descSource.convertTo(source, CV_32F);
+            descRef.convertTo(ref, CV_32F);
         }
         matcher = cv::FlannBasedMatcher::create();
 
@@ -33,14 +36,14 @@ void matchDescriptors(std::vector<cv::KeyPoint> &kPtsSource, std::vector<cv::Key
     if (selectorType.compare("SEL_NN") == 0)
     { // nearest neighbor (best match)
 
-        matcher->match(descSource, descRef, matches); // Finds the best match for each descriptor in desc1
+        matcher->match(source, ref, matches); // Finds the best match for each descriptor in desc1
     }
 	else if (selectorType.compare("SEL_KNN") == 0)
     { // k nearest neighbors (k=2)
 
         // TASK MP.6 FLANN Distance Matching Gaurav Borgaonkar Implementation //
         vector<vector<cv::DMatch>> matches_knn;
-        matcher->knnMatch(descSource, descRef, matches_knn, 2);
+        matcher->knnMatch(source, ref, matches_knn, 2);
         double minDescDistRatio = 0.8;
 
         for (auto it = matches_knn.begin(); it != matches_knn.end(); ++it)
@@ -153,46 +156,68 @@ void detKeypointsHarris(vector<cv::KeyPoint> &keypoints, cv::Mat &img, bool bVis
     double k = 0.04;       // Harris parameter (see equation for details)
 	
 	// Detect Harris corners and normalize output
-    cv::Mat dst, dst_norm, dst_norm_scaled;
-    dst = cv::Mat::zeros(img.size(), CV_32FC1);
+    cv::Mat dst, dst_norm;
     cv::cornerHarris(img, dst, blockSize, apertureSize, k, cv::BORDER_DEFAULT);
     cv::normalize(dst, dst_norm, 0, 255, cv::NORM_MINMAX, CV_32FC1, cv::Mat());
-    cv::convertScaleAbs(dst_norm, dst_norm_scaled);
-	
 
-    double maxOverlap = 0.0; // max. permissible overlap between two features in %, used during non-maxima suppression
-    for (size_t j = 0; j < dst_norm.rows; j++)
+    // non-maximum suppression, identical to comparing each new key point with all key points found so far : Harris key
+    // points all have the same diameter, so two of them overlap exactly if they are closer than the diameter. Key points
+    // are bucketed into grid cells with the size of the diameter, hence only the 3x3 cells around a new one are searched.
+    // Key points passed in by the caller are kept but take no part in the suppression.
+    int diameter = 2 * apertureSize;
+    int gridCols = (dst_norm.cols + diameter - 1) / diameter, gridRows = (dst_norm.rows + diameter - 1) / diameter;
+    vector<vector<int>> cells(gridCols * gridRows); // indices into keypoints
+    vector<int> overlapping;
+
+    for (int j = 0; j < dst_norm.rows; j++)
     {
-        for (size_t i = 0; i < dst_norm.cols; i++)
+        const float *row = dst_norm.ptr<float>(j);
+        int cy = j / diameter;
+        for (int i = 0; i < dst_norm.cols; i++)
         {
-            int response = (int)dst_norm.at<float>(j, i);
-            if (response > minResponse)
-            { // only store points above a threshold
-
-                cv::KeyPoint newKeyPoint;
-                newKeyPoint.pt = cv::Point2f(i, j);
-                newKeyPoint.size = 2 * apertureSize;
-                newKeyPoint.response = response;
-
-                // perform non-maximum suppression (NMS) in local neighbourhood around new key point
-                bool bOverlap = false;
-                for (auto it = keypoints.begin(); it != keypoints.end(); ++it)
+            int response = (int)row[i];
+            if (response <= minResponse)
+                continue; // only store points above a threshold
+
+            // key points overlapping the new one, in the order of the key point list
+            int cx = i / diameter;
+            overlapping.clear();
+            for (int gy = max(0, cy - 1); gy <= min(gridRows - 1, cy + 1); ++gy)
+            {
+                for (int gx = max(0, cx - 1); gx <= min(gridCols - 1, cx + 1); ++gx)
                 {
-                    double keyptsOverlap = cv::KeyPoint::overlap(newKeyPoint, *it);
-                    if (keyptsOverlap > maxOverlap)
+                    for (int idx : cells[gy * gridCols + gx])
                     {
-                        bOverlap = true;
-                        if (newKeyPoint.response > (*it).response)
-                        {                      // if overlap is >t AND response is higher for new kpt
-                            *it = newKeyPoint; // replace old key point with new one
-                            break;             // quit loop over keypoints
-                        }
+                        float dx = keypoints[idx].pt.x - i, dy = keypoints[idx].pt.y - j;
+                        if (dx * dx + dy * dy < diameter * diameter)
+                            overlapping.push_back(idx);
                     }
                 }
-                if (!bOverlap)
-                    // only add new key point if no overlap has been found in previous NMS and store new keypoint in dynamic list
-                    keypoints.push_back(newKeyPoint);
-
+            }
+            sort(overlapping.begin(), overlapping.end());
+
+            cv::KeyPoint newKeyPoint;
+            newKeyPoint.pt = cv::Point2f(i, j);
+            newKeyPoint.size = diameter;
+            newKeyPoint.response = response;
+
+            if (overlapping.empty())
+            { // store new keypoint in dynamic list
+                cells[cy * gridCols + cx].push_back(keypoints.size());
+                keypoints.push_back(newKeyPoint);
+                continue;
+            }
+            for (int idx : overlapping)
+            {
+                if (newKeyPoint.response > keypoints[idx].response)
+                { // replace the first overlapping key point with a lower response and move it to the cell of the new one
+                    vector<int> &oldCell = cells[(int)keypoints[idx].pt.y / diameter * gridCols + (int)keypoints[idx].pt.x / diameter];
+                    *find(oldCell.begin(), oldCell.end(), idx) = oldCell.back();
+                    oldCell.pop_back();
+                    cells[cy * gridCols + cx].push_back(idx);
+                    keypoints[idx] = newKeyPoint;
+                    break;
+                }
             }
         } // eof loop over columns
     }   // eof loop over rows
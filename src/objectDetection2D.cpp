@@ -12,58 +12,138 @@
 
 using namespace std;
 
-// detects objects in an image using the YOLO library and a set of pre-trained objects from the COCO database;
-// a set of 80 classes is listed in "coco.names" and pre-trained weights are stored in "yolov3.weights"
-void detectObjects(cv::Mat& img, std::vector<BoundingBox>& bBoxes, float confThreshold, float nmsThreshold, 
-                   std::string basePath, std::string classesFile, std::string modelConfiguration, std::string modelWeights, bool bVis)
+// loads the set of 80 classes listed in "coco.names" and the pre-trained weights stored in "yolov3.weights" once
+ObjectDetector::ObjectDetector(std::string classesFile, std::string modelConfiguration, std::string modelWeights,
+                               float confThreshold, float nmsThreshold)
+    : confThreshold(confThreshold), nmsThreshold(nmsThreshold),
+      loadTime(0.0), firstFrameTime(0.0), steadyTotalTime(0.0), steadyForwardTime(0.0), frameCount(0), steadyFrameCount(0)
 {
+    double t = (double)cv::getTickCount();
+
     // load class names from file
-    vector<string> classes;
     ifstream ifs(classesFile.c_str());
     string line;
     while (getline(ifs, line)) classes.push_back(line);
-    
+
     // load neural network
-    cv::dnn::Net net = cv::dnn::readNetFromDarknet(modelConfiguration, modelWeights);
+    net = cv::dnn::readNetFromDarknet(modelConfiguration, modelWeights);
     net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
     net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-    
-    // generate 4D blob from input image
-    cv::Mat blob;
-    vector<cv::Mat> netOutput;
+
+    // Get names of output layers
+    vector<int> outLayers = net.getUnconnectedOutLayers(); // get  indices of  output layers, i.e.  layers with unconnected outputs
+    vector<cv::String> layersNames = net.getLayerNames(); // get  names of all layers in the network
+
+    outputNames.resize(outLayers.size());
+    for (size_t i = 0; i < outLayers.size(); ++i) // Get the names of the output layers in names
+        outputNames[i] = layersNames[outLayers[i] - 1];
+
+    loadTime = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+}
+
+// detects objects in an image using the YOLO network loaded in the constructor
+void ObjectDetector::detect(const cv::Mat &img, std::vector<BoundingBox> &bBoxes, bool bVis)
+{
+    double t = (double)cv::getTickCount();
+
+    // generate 4D blob from input image, re-using the blob buffer of the previous frame
+    batchImgs.resize(1);
+    batchImgs[0] = img;
+    double tForward;
+    forward(batchImgs, tForward);
+    decodeOutput(img, 0, 1, bBoxes);
+    batchImgs[0].release();
+
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    updateTiming(t, tForward, 1);
+
+    // show results
+    if (bVis)
+    {
+        visualize(img, bBoxes);
+    }
+}
+
+void ObjectDetector::detect(const std::vector<cv::Mat> &imgs, std::vector<std::vector<BoundingBox>> &bBoxes)
+{
+    bBoxes.resize(imgs.size());
+    if (imgs.empty())
+    {
+        return;
+    }
+
+    double t = (double)cv::getTickCount();
+
+    double tForward;
+    forward(imgs, tForward);
+    for (size_t i = 0; i < imgs.size(); ++i)
+    {
+        decodeOutput(imgs[i], (int)i, (int)imgs.size(), bBoxes[i]);
+    }
+
+    t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+    updateTiming(t, tForward, (int)imgs.size());
+}
+
+// generate 4D blob with one entry per image and invoke forward propagation through network
+void ObjectDetector::forward(const std::vector<cv::Mat> &imgs, double &tForward)
+{
     double scalefactor = 1/255.0;
     cv::Size size = cv::Size(416, 416);
     cv::Scalar mean = cv::Scalar(0,0,0);
     bool swapRB = false;
     bool crop = false;
-    cv::dnn::blobFromImage(img, blob, scalefactor, size, mean, swapRB, crop);
-    
-    // Get names of output layers
-    vector<cv::String> names;
-    vector<int> outLayers = net.getUnconnectedOutLayers(); // get  indices of  output layers, i.e.  layers with unconnected outputs
-    vector<cv::String> layersNames = net.getLayerNames(); // get  names of all layers in the network
-    
-    names.resize(outLayers.size());
-    for (size_t i = 0; i < outLayers.size(); ++i) // Get the names of the output layers in names
-        names[i] = layersNames[outLayers[i] - 1];
-    
-    // invoke forward propagation through network
+    cv::dnn::blobFromImages(imgs, blob, scalefactor, size, mean, swapRB, crop);
+
+    tForward = (double)cv::getTickCount();
     net.setInput(blob);
-    net.forward(netOutput, names);
-    
-    // Scan through all bounding boxes and keep only the ones with high confidence
-    vector<int> classIds; vector<float> confidences; vector<cv::Rect> boxes;
+    net.forward(netOutput, outputNames);
+    tForward = ((double)cv::getTickCount() - tForward) / cv::getTickFrequency();
+}
+
+void ObjectDetector::updateTiming(double t, double tForward, int nFrames)
+{
+    // the first forward pass includes the lazy network initialization and is therefore reported separately
+    if (frameCount == 0)
+    {
+        firstFrameTime = t / nFrames;
+    }
+    else
+    {
+        steadyTotalTime += t;
+        steadyForwardTime += tForward;
+        steadyFrameCount += nFrames;
+    }
+    frameCount += nFrames;
+}
+
+// Scan through all bounding boxes of the network output which belong to image batchIdx, keep only the ones 
+// with high confidence and perform non-maxima suppression on them
+void ObjectDetector::decodeOutput(const cv::Mat &img, int batchIdx, int batchSize, std::vector<BoundingBox> &bBoxes)
+{
+    classIds.clear(); confidences.clear(); boxes.clear(); indices.clear();
     for (size_t i = 0; i < netOutput.size(); ++i)
     {
-        float* data = (float*)netOutput[i].data;
-        for (int j = 0; j < netOutput[i].rows; ++j, data += netOutput[i].cols)
+        // output is either [batch*rows x cols] or [batch x rows x cols], the rows of one image are contiguous in both cases
+        const cv::Mat &output = netOutput[i];
+        int cols = output.size[output.dims - 1];
+        int rows = (int)(output.total() / cols) / batchSize;
+
+        const float* data = (const float*)output.data + (size_t)batchIdx * rows * cols;
+        for (int j = 0; j < rows; ++j, data += cols)
         {
-            cv::Mat scores = netOutput[i].row(j).colRange(5, netOutput[i].cols);
-            cv::Point classId;
-            double confidence;
-            
             // Get the value and location of the maximum score
-            cv::minMaxLoc(scores, 0, &confidence, 0, &classId);
+            int classId = 0;
+            float confidence = data[5];
+            for (int c = 6; c < cols; ++c)
+            {
+                if (data[c] > confidence)
+                {
+                    confidence = data[c];
+                    classId = c - 5;
+                }
+            }
+
             if (confidence > confThreshold)
             {
                 cv::Rect box; int cx, cy;
@@ -75,14 +155,13 @@ void detectObjects(cv::Mat& img, std::vector<BoundingBox>& bBoxes, float confThr
                 box.y = cy - box.height/2; // top
                 
                 boxes.push_back(box);
-                classIds.push_back(classId.x);
-                confidences.push_back((float)confidence);
+                classIds.push_back(classId);
+                confidences.push_back(confidence);
             }
         }
     }
     
     // perform non-maxima suppression
-    vector<int> indices;
     cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
     for(auto it=indices.begin(); it!=indices.end(); ++it) {
         
@@ -91,39 +170,64 @@ void detectObjects(cv::Mat& img, std::vector<BoundingBox>& bBoxes, float confThr
         bBox.classID = classIds[*it];
         bBox.confidence = confidences[*it];
         bBox.boxID = (int)bBoxes.size(); // zero-based unique identifier for this bounding box
+        bBox.trackID = -1; // assigned once the box has been matched to the previous frame
         
         bBoxes.push_back(bBox);
     }
-    
-    // show results
-    if(bVis) {
+}
+
+void ObjectDetector::visualize(const cv::Mat &img, const std::vector<BoundingBox> &bBoxes) const
+{
+    cv::Mat visImg = img.clone();
+    for(auto it=bBoxes.begin(); it!=bBoxes.end(); ++it) {
         
-        cv::Mat visImg = img.clone();
-        for(auto it=bBoxes.begin(); it!=bBoxes.end(); ++it) {
-            
-            // Draw rectangle displaying the bounding box
-            int top, left, width, height;
-            top = (*it).roi.y;
-            left = (*it).roi.x;
-            width = (*it).roi.width;
-            height = (*it).roi.height;
-            cv::rectangle(visImg, cv::Point(left, top), cv::Point(left+width, top+height),cv::Scalar(0, 255, 0), 2);
-            
-            string label = cv::format("%.2f", (*it).confidence);
-            label = classes[((*it).classID)] + ":" + label;
+        // Draw rectangle displaying the bounding box
+        int top, left, width, height;
+        top = (*it).roi.y;
+        left = (*it).roi.x;
+        width = (*it).roi.width;
+        height = (*it).roi.height;
+        cv::rectangle(visImg, cv::Point(left, top), cv::Point(left+width, top+height),cv::Scalar(0, 255, 0), 2);
         
-            // Display label at the top of the bounding box
-            int baseLine;
-            cv::Size labelSize = getTextSize(label, cv::FONT_ITALIC, 0.5, 1, &baseLine);
-            top = max(top, labelSize.height);
-            rectangle(visImg, cv::Point(left, top - round(1.5*labelSize.height)), cv::Point(left + round(1.5*labelSize.width), top + baseLine), cv::Scalar(255, 255, 255), cv::FILLED);
-            cv::putText(visImg, label, cv::Point(left, top), cv::FONT_ITALIC, 0.75, cv::Scalar(0,0,0),1);
-            
-        }
+        string label = cv::format("%.2f", (*it).confidence);
+        label = classes[((*it).classID)] + ":" + label;
+    
+        // Display label at the top of the bounding box
+        int baseLine;
+        cv::Size labelSize = getTextSize(label, cv::FONT_ITALIC, 0.5, 1, &baseLine);
+        top = max(top, labelSize.height);
+        rectangle(visImg, cv::Point(left, top - round(1.5*labelSize.height)), cv::Point(left + round(1.5*labelSize.width), top + baseLine), cv::Scalar(255, 255, 255), cv::FILLED);
+        cv::putText(visImg, label, cv::Point(left, top), cv::FONT_ITALIC, 0.75, cv::Scalar(0,0,0),1);
         
-        string windowName = "Object classification";
-        cv::namedWindow( windowName, 1 );
-        cv::imshow( windowName, visImg );
-        cv::waitKey(0); // wait for key to be pressed
     }
+    
+    string windowName = "Object classification";
+    cv::namedWindow( windowName, 1 );
+    cv::imshow( windowName, visImg );
+    cv::waitKey(0); // wait for key to be pressed
+}
+
+void ObjectDetector::printTimingReport() const
+{
+    cout << "YOLO startup (classes + network + output layers) : " << 1000 * loadTime << " ms" << endl;
+    if (frameCount > 0)
+    {
+        cout << "YOLO first frame (incl. network initialization) : " << 1000 * firstFrameTime << " ms" << endl;
+    }
+    if (steadyFrameCount > 0)
+    {
+        int n = steadyFrameCount;
+        cout << "YOLO steady state over " << n << " frames : " << 1000 * steadyTotalTime / n << " ms/frame, of which forward pass "
+             << 1000 * steadyForwardTime / n << " ms/frame" << endl;
+    }
+}
+
+
+// detects objects in an image using the YOLO library and a set of pre-trained objects from the COCO database;
+// a set of 80 classes is listed in "coco.names" and pre-trained weights are stored in "yolov3.weights"
+void detectObjects(cv::Mat& img, std::vector<BoundingBox>& bBoxes, float confThreshold, float nmsThreshold, 
+                   std::string basePath, std::string classesFile, std::string modelConfiguration, std::string modelWeights, bool bVis)
+{
+    ObjectDetector detector(classesFile, modelConfiguration, modelWeights, confThreshold, nmsThreshold);
+    detector.detect(img, bBoxes, bVis);
 }
@@ -3,10 +3,63 @@
 #define objectDetection2D_hpp
 
 #include <stdio.h>
+#include <string>
+#include <vector>
 #include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
 
 #include "dataStructures.h"
 
+// YOLO object detector which loads class names, network and output layer names once and is then reused for every frame
+class ObjectDetector
+{
+public:
+    ObjectDetector(std::string classesFile, std::string modelConfiguration, std::string modelWeights,
+                   float confThreshold = 0.2, float nmsThreshold = 0.4);
+
+    // detects objects in img and appends them to bBoxes (boxID continues from the current size of bBoxes)
+    void detect(const cv::Mat &img, std::vector<BoundingBox> &bBoxes, bool bVis = false);
+
+    // detects objects in a batch of images with a single forward pass and appends the results to bBoxes[i] for imgs[i]
+    void detect(const std::vector<cv::Mat> &imgs, std::vector<std::vector<BoundingBox>> &bBoxes);
+
+    // prints startup cost vs. steady-state per-frame cost
+    void printTimingReport() const;
+
+    const std::vector<std::string> &classNames() const { return classes; }
+
+private:
+    void forward(const std::vector<cv::Mat> &imgs, double &tForward);
+    void decodeOutput(const cv::Mat &img, int batchIdx, int batchSize, std::vector<BoundingBox> &bBoxes);
+    void updateTiming(double t, double tForward, int nFrames);
+    void visualize(const cv::Mat &img, const std::vector<BoundingBox> &bBoxes) const;
+
+    std::vector<std::string> classes; // names of all classes the network has been trained on
+    cv::dnn::Net net;
+    std::vector<cv::String> outputNames; // names of the unconnected output layers
+
+    float confThreshold;
+    float nmsThreshold;
+
+    // buffers which are reused across frames
+    cv::Mat blob;
+    std::vector<cv::Mat> batchImgs;
+    std::vector<cv::Mat> netOutput;
+    std::vector<int> classIds;
+    std::vector<float> confidences;
+    std::vector<cv::Rect> boxes;
+    std::vector<int> indices;
+
+    // timing statistics in seconds
+    double loadTime;
+    double firstFrameTime;
+    double steadyTotalTime;
+    double steadyForwardTime;
+    int frameCount;
+    int steadyFrameCount;
+};
+
+// convenience wrapper which loads the network on every call; prefer ObjectDetector when processing a sequence
 void detectObjects(cv::Mat& img, std::vector<BoundingBox>& bBoxes, float confThreshold, float nmsThreshold, 
                    std::string basePath, std::string classesFile, std::string modelConfiguration, std::string modelWeights, bool bVis);
 
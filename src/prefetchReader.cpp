@@ -0,0 +1,159 @@
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <stdexcept>
+#include <opencv2/imgcodecs.hpp>
+
+#include "prefetchReader.hpp"
+#include "lidarData.hpp"
+
+using namespace std;
+
+static double secondsSince(chrono::steady_clock::time_point t0)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+PrefetchReader::PrefetchReader(ReadFunction read, int startIndex, int endIndex, int step, size_t depth, size_t nThreads)
+    : read(read), startIndex(startIndex), step(step), nFrames(0), nextToRead(0), nConsumed(0), bStopping(false), nStalls(0),
+      stallSeconds(0.0), readSeconds(0.0)
+{
+    if (step < 1 || depth < 1)
+    {
+        throw invalid_argument("PrefetchReader: step and depth must be positive");
+    }
+    nFrames = endIndex >= startIndex ? (endIndex - startIndex) / step + 1 : 0;
+    slots.resize(depth);
+    for (auto &slot : slots)
+    {
+        slot.state = SlotState::Free;
+        slot.readSeconds = 0.0;
+    }
+    for (size_t i = 0; i < max((size_t)1, min(nThreads, depth)); ++i)
+    {
+        workers.push_back(thread(&PrefetchReader::workerLoop, this));
+    }
+}
+
+PrefetchReader::~PrefetchReader()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        bStopping = true;
+    }
+    slotFree.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void PrefetchReader::workerLoop()
+{
+    unique_lock<mutex> lock(mtx);
+    while (true)
+    {
+        // the slot of frame k is free once frame k - depth has been consumed
+        slotFree.wait(lock, [this] { return bStopping || nextToRead >= nFrames || nextToRead < nConsumed + slots.size(); });
+        if (bStopping || nextToRead >= nFrames)
+        {
+            return;
+        }
+        size_t k = nextToRead++;
+        Slot &slot = slots[k % slots.size()];
+        slot.state = SlotState::Reading;
+        lock.unlock();
+
+        auto t0 = chrono::steady_clock::now();
+        try
+        {
+            slot.frame.index = startIndex + (int)k * step;
+            read(slot.frame.index, slot.frame);
+        }
+        catch (...)
+        {
+            slot.error = current_exception();
+        }
+        double t = secondsSince(t0);
+
+        lock.lock();
+        slot.readSeconds = t;
+        slot.state = SlotState::Ready;
+        slotReady.notify_all();
+    }
+}
+
+bool PrefetchReader::next(SensorFrame &frame)
+{
+    unique_lock<mutex> lock(mtx);
+    if (nConsumed >= nFrames)
+    {
+        return false;
+    }
+    Slot &slot = slots[nConsumed % slots.size()];
+    if (slot.state != SlotState::Ready)
+    {
+        ++nStalls;
+        auto t0 = chrono::steady_clock::now();
+        slotReady.wait(lock, [&slot] { return slot.state == SlotState::Ready; });
+        stallSeconds += secondsSince(t0);
+    }
+    // a frame whose read failed counts as consumed, so that a later call continues with the following frame
+    exception_ptr error = slot.error;
+    slot.error = nullptr;
+    if (!error)
+    {
+        swap(frame, slot.frame); // the slot keeps the buffers of the consumer's previous frame for a later read
+    }
+    readSeconds += slot.readSeconds;
+    slot.state = SlotState::Free;
+    ++nConsumed;
+    slotFree.notify_all();
+    if (error)
+    {
+        rethrow_exception(error);
+    }
+    return true;
+}
+
+void PrefetchReader::printReport() const
+{
+    ios_base::fmtflags flags = cout.flags();
+    streamsize precision = cout.precision();
+    cout << "Prefetch reader : " << nConsumed << " frames, " << workers.size() << " threads, depth " << slots.size() << ", "
+         << fixed << setprecision(1) << 1000 * readSeconds / max((size_t)1, nConsumed) << " ms/frame reading, " << nStalls
+         << " stalls (" << 1000 * stallSeconds << " ms waited)" << endl;
+    cout.flags(flags);
+    cout.precision(precision);
+}
+
+PrefetchReader::ReadFunction directoryReader(const string &imgPrefix, const string &imgFileType, const string &lidarPrefix,
+                                             const string &lidarFileType, int fillWidth)
+{
+    return [=](int index, SensorFrame &frame) {
+        ostringstream imgNumber;
+        imgNumber << setfill('0') << setw(fillWidth) << index;
+        frame.cameraImg = cv::imread(imgPrefix + imgNumber.str() + imgFileType);
+        if (frame.cameraImg.empty())
+        {
+            throw runtime_error("directoryReader: cannot read " + imgPrefix + imgNumber.str() + imgFileType);
+        }
+        LidarScan scan;
+        if (!scan.open(lidarPrefix + imgNumber.str() + lidarFileType))
+        {
+            throw runtime_error("directoryReader: cannot read " + lidarPrefix + imgNumber.str() + lidarFileType);
+        }
+        LidarCloud &lidarPoints = frame.lidarPoints;
+        lidarPoints.resize(scan.size());
+        lidarPoints.boxIDs.clear();
+        for (size_t i = 0; i < scan.size(); ++i)
+        {
+            lidarPoints.x[i] = scan[i].x;
+            lidarPoints.y[i] = scan[i].y;
+            lidarPoints.z[i] = scan[i].z;
+            lidarPoints.r[i] = scan[i].r;
+        }
+    };
+}
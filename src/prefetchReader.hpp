@@ -0,0 +1,85 @@
+
+#ifndef prefetchReader_hpp
+#define prefetchReader_hpp
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+// camera image and Lidar scan of one frame as read from storage
+struct SensorFrame
+{
+    int index; // file index of the frame in the recorded sequence
+    cv::Mat cameraImg;
+    LidarCloud lidarPoints; // the complete scan, not yet cropped
+
+    SensorFrame() : index(-1) {}
+};
+
+// reads the frames startIndex, startIndex + step, ... up to endIndex on background threads, at most depth frames ahead
+// of the consumer, and hands them out in sequence order. Workers may finish out of order; every frame has a slot in a
+// ring keyed by its position in the sequence, so the consumer only waits for the frame it needs next.
+class PrefetchReader
+{
+public:
+    // reads frame index into frame, whose buffers are those of a frame handed out before and may be re-used; called on
+    // several threads at once
+    typedef std::function<void(int index, SensorFrame &frame)> ReadFunction;
+
+    PrefetchReader(ReadFunction read, int startIndex, int endIndex, int step = 1, size_t depth = 4, size_t nThreads = 2);
+    ~PrefetchReader(); // stops reading and joins the threads
+
+    PrefetchReader(const PrefetchReader &) = delete;
+    PrefetchReader &operator=(const PrefetchReader &) = delete;
+
+    // swaps the next frame of the sequence into frame (the buffers of frame are re-used for a later read), waiting until it
+    // has been read; returns false at the end of the sequence. If the read function failed for the frame, its exception
+    // is rethrown and frame is left unchanged; the failed frame is skipped, a further call returns the frame after it
+    bool next(SensorFrame &frame);
+
+    size_t frames() const { return nConsumed; }
+    size_t stalls() const { return nStalls; } // calls of next which had to wait, i.e. the consumer was starved
+    double stallTime() const { return stallSeconds; } // [s] spent waiting in next
+    void printReport() const;
+
+private:
+    enum class SlotState { Free, Reading, Ready };
+    struct Slot
+    {
+        SlotState state;
+        SensorFrame frame;
+        std::exception_ptr error;
+        double readSeconds;
+    };
+
+    void workerLoop();
+
+    ReadFunction read;
+    int startIndex, step;
+    size_t nFrames; // no. of frames in the sequence
+    std::vector<Slot> slots; // frame k of the sequence uses slot k % depth
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable slotFree;  // the consumer has taken a frame, or the reader is stopping
+    std::condition_variable slotReady; // a worker has finished a frame
+    size_t nextToRead, nConsumed;
+    bool bStopping;
+
+    size_t nStalls;
+    double stallSeconds, readSeconds;
+};
+
+// read function for the KITTI directory layout : one image and one Velodyne scan file per frame, named by the prefix
+// followed by the zero-padded file index (fillWidth digits) and the file type; throws std::runtime_error if either file of a
+// frame cannot be read
+PrefetchReader::ReadFunction directoryReader(const std::string &imgPrefix, const std::string &imgFileType,
+                                             const std::string &lidarPrefix, const std::string &lidarFileType, int fillWidth);
+
+#endif /* prefetchReader_hpp */
@@ -0,0 +1,166 @@
+
+#include <algorithm>
+
+#include "roiIndex.hpp"
+#include "dataStructures.h"
+
+using namespace std;
+
+static const long maxCells = 16384;
+
+void RoiGridIndex::build(const std::vector<BoundingBox> &boundingBoxes, float shrinkFactor, int cellSize)
+{
+    rois.resize(boundingBoxes.size());
+    for (size_t i = 0; i < boundingBoxes.size(); ++i)
+    {
+        // same arithmetic as the per-point shrinking in clusterLidarWithROI, so that the rectangles are identical
+        const cv::Rect &roi = boundingBoxes[i].roi;
+        rois[i].x = roi.x + shrinkFactor * roi.width / 2.0;
+        rois[i].y = roi.y + shrinkFactor * roi.height / 2.0;
+        rois[i].width = roi.width * (1 - shrinkFactor);
+        rois[i].height = roi.height * (1 - shrinkFactor);
+    }
+    buildGrid(cellSize);
+}
+
+void RoiGridIndex::build(const std::vector<cv::Rect> &rects, int cellSize)
+{
+    rois = rects;
+    buildGrid(cellSize);
+}
+
+// rois are set, the vectors of a previous build keep their capacity
+void RoiGridIndex::buildGrid(int cellSize)
+{
+    cellStart.clear();
+    cellBoxes.clear();
+    cols = rows = 0;
+    this->cellSize = max(1, cellSize);
+
+    // grid covers the bounding rectangle of all non-empty ROIs
+    int minX = 0, minY = 0, maxX = 0, maxY = 0; // maxX and maxY are exclusive
+    bool bAny = false;
+    for (auto it = rois.begin(); it != rois.end(); ++it)
+    {
+        if (it->width <= 0 || it->height <= 0)
+        {
+            continue;
+        }
+        minX = bAny ? min(minX, it->x) : it->x;
+        minY = bAny ? min(minY, it->y) : it->y;
+        maxX = bAny ? max(maxX, it->x + it->width) : it->x + it->width;
+        maxY = bAny ? max(maxY, it->y + it->height) : it->y + it->height;
+        bAny = true;
+    }
+    if (!bAny)
+    {
+        return;
+    }
+    origin = cv::Point(minX, minY);
+    do // coarsen the grid for huge ROIs so that it stays small
+    {
+        cols = (maxX - minX + this->cellSize - 1) / this->cellSize;
+        rows = (maxY - minY + this->cellSize - 1) / this->cellSize;
+    } while ((long)cols * rows > maxCells && (this->cellSize *= 2));
+
+    // count the boxes per cell, then fill them in (compressed row storage)
+    cellStart.assign(cols * rows + 1, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+        {
+            for (size_t c = 1; c < cellStart.size(); ++c)
+            {
+                cellStart[c] += cellStart[c - 1];
+            }
+            cellBoxes.resize(cellStart.back());
+            cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        }
+
+        for (size_t i = 0; i < rois.size(); ++i)
+        {
+            const cv::Rect &roi = rois[i];
+            if (roi.width <= 0 || roi.height <= 0)
+            {
+                continue;
+            }
+            int c0 = (roi.x - origin.x) / this->cellSize, c1 = (roi.x + roi.width - 1 - origin.x) / this->cellSize;
+            int r0 = (roi.y - origin.y) / this->cellSize, r1 = (roi.y + roi.height - 1 - origin.y) / this->cellSize;
+            for (int r = r0; r <= r1; ++r)
+            {
+                for (int c = c0; c <= c1; ++c)
+                {
+                    if (pass == 0)
+                    {
+                        ++cellStart[r * cols + c + 1];
+                    }
+                    else
+                    {
+                        cellBoxes[cellFill[r * cols + c]++] = (int)i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void RoiGridIndex::clear()
+{
+    rois.clear();
+    cellStart.clear();
+    cellBoxes.clear();
+    cols = rows = 0;
+}
+
+int RoiGridIndex::cellOf(const cv::Point &pt) const
+{
+    int dx = pt.x - origin.x, dy = pt.y - origin.y;
+    if (dx < 0 || dy < 0)
+    {
+        return -1;
+    }
+    int c = dx / cellSize, r = dy / cellSize;
+    if (c >= cols || r >= rows)
+    {
+        return -1;
+    }
+    return r * cols + c;
+}
+
+void RoiGridIndex::query(const cv::Point &pt, std::vector<int> &boxIndices) const
+{
+    int cell = cellOf(pt);
+    if (cell < 0)
+    {
+        return;
+    }
+    for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k)
+    {
+        if (rois[cellBoxes[k]].contains(pt))
+        {
+            boxIndices.push_back(cellBoxes[k]);
+        }
+    }
+}
+
+int RoiGridIndex::queryUnique(const cv::Point &pt) const
+{
+    int cell = cellOf(pt);
+    if (cell < 0)
+    {
+        return -1;
+    }
+    int found = -1;
+    for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k)
+    {
+        if (rois[cellBoxes[k]].contains(pt))
+        {
+            if (found >= 0)
+            {
+                return -1; // enclosed by several boxes
+            }
+            found = cellBoxes[k];
+        }
+    }
+    return found;
+}
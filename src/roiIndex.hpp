@@ -0,0 +1,43 @@
+
+#ifndef roiIndex_hpp
+#define roiIndex_hpp
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+struct BoundingBox;
+
+// uniform grid over the (optionally shrunken) ROIs of a frame's bounding boxes, answers which boxes contain a pixel
+// by testing only the boxes registered in the pixel's grid cell; must be rebuilt whenever the boxes change, which re-uses
+// the buffers of the previous build
+class RoiGridIndex
+{
+public:
+    RoiGridIndex() : cellSize(32), cols(0), rows(0) {}
+
+    // shrinkFactor shrinks each ROI like clusterLidarWithROI does, cellSize is the edge length of a grid cell in pixels
+    void build(const std::vector<BoundingBox> &boundingBoxes, float shrinkFactor=0.0f, int cellSize=32);
+    void build(const std::vector<cv::Rect> &rois, int cellSize=32);
+    void clear();
+
+    // indices of all boxes which contain pt, in ascending order, appended to boxIndices
+    void query(const cv::Point &pt, std::vector<int> &boxIndices) const;
+    // index of the box containing pt if there is exactly one such box, -1 otherwise
+    int queryUnique(const cv::Point &pt) const;
+
+    const std::vector<cv::Rect> &rects() const { return rois; }
+    size_t size() const { return rois.size(); }
+
+private:
+    void buildGrid(int cellSize);
+    int cellOf(const cv::Point &pt) const;
+
+    std::vector<cv::Rect> rois; // ROI per box, shrunken if requested
+    cv::Point origin; // top-left corner of the grid
+    int cellSize, cols, rows;
+    std::vector<int> cellStart; // boxes of cell c are cellBoxes[cellStart[c]] ... cellBoxes[cellStart[c+1]-1]
+    std::vector<int> cellBoxes;
+    std::vector<int> cellFill; // scratch : next free slot per cell while building
+};
+
+#endif /* roiIndex_hpp */
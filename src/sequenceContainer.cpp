@@ -0,0 +1,350 @@
+
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+#include <opencv2/imgcodecs.hpp>
+
+#include "sequenceContainer.hpp"
+
+using namespace std;
+
+static const char sequenceMagic[4] = {'K', 'S', 'E', 'Q'};
+static const uint32_t sequenceVersion = 1;
+static const size_t calibrationSize = 3 * 4 + 4 * 4 + 4 * 4; // no. of doubles in P_rect_00, R_rect_00, RT
+static const uchar pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+// a buffer which someone else still references must not be overwritten in place
+static void releaseIfShared(cv::Mat &img)
+{
+    if (img.u && img.u->refcount > 1)
+    {
+        img.release();
+    }
+}
+
+static uint32_t readBigEndian32(const uchar *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+SequenceWriter::SequenceWriter(const string &filename, ImageEncoding encoding) : encoding(encoding), position(0)
+{
+    file.open(filename, ios::binary | ios::trunc);
+    if (!file)
+    {
+        throw runtime_error("SequenceWriter: cannot create " + filename);
+    }
+    char header[8];
+    memcpy(header, sequenceMagic, 4);
+    memcpy(header + 4, &sequenceVersion, 4);
+    writeAligned(header, sizeof(header));
+}
+
+SequenceWriter::~SequenceWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const exception &)
+    {
+        // errors are only reported by an explicit close
+    }
+}
+
+void SequenceWriter::writeAligned(const void *data, size_t nBytes)
+{
+    static const char padding[8] = {0};
+    file.write((const char *)data, nBytes);
+    size_t nPadding = (8 - (position + nBytes) % 8) % 8;
+    file.write(padding, nPadding);
+    position += nBytes + nPadding;
+}
+
+void SequenceWriter::writeFrame(SequenceFrameEntry entry, const uchar *imgBytes, const LidarRecord *lidarRecords, size_t nRecords)
+{
+    if (!file.is_open())
+    {
+        throw runtime_error("SequenceWriter: frame added after close");
+    }
+    entry.imageOffset = position;
+    writeAligned(imgBytes, entry.imageSize);
+    entry.lidarOffset = position;
+    entry.lidarCount = nRecords;
+    writeAligned(lidarRecords, nRecords * sizeof(LidarRecord));
+    if (!file)
+    {
+        throw runtime_error("SequenceWriter: writing frame " + to_string(entry.fileIndex) + " failed");
+    }
+    entries.push_back(entry);
+}
+
+void SequenceWriter::addFrame(int fileIndex, const cv::Mat &img, const LidarRecord *lidarRecords, size_t nRecords)
+{
+    if (img.empty())
+    {
+        throw invalid_argument("SequenceWriter: image of frame " + to_string(fileIndex) + " is empty");
+    }
+    SequenceFrameEntry entry = {};
+    entry.fileIndex = fileIndex;
+    entry.encoding = (int32_t)encoding;
+    entry.rows = img.rows;
+    entry.cols = img.cols;
+    entry.type = img.type();
+
+    if (encoding == ImageEncoding::PNG)
+    {
+        if (!cv::imencode(".png", img, encoded))
+        {
+            throw runtime_error("SequenceWriter: image of frame " + to_string(fileIndex) + " cannot be PNG-encoded");
+        }
+        entry.imageSize = encoded.size();
+        writeFrame(entry, encoded.data(), lidarRecords, nRecords);
+    }
+    else
+    {
+        cv::Mat pixels = img.isContinuous() ? img : img.clone();
+        entry.imageSize = pixels.total() * pixels.elemSize();
+        writeFrame(entry, pixels.data, lidarRecords, nRecords);
+    }
+}
+
+void SequenceWriter::addEncodedFrame(int fileIndex, const vector<uchar> &pngBytes, const LidarRecord *lidarRecords, size_t nRecords)
+{
+    // signature, chunk length and type of IHDR, then width and height
+    if (pngBytes.size() < 24 || memcmp(pngBytes.data(), pngSignature, sizeof(pngSignature)) != 0)
+    {
+        throw invalid_argument("SequenceWriter: image of frame " + to_string(fileIndex) + " is not a PNG file");
+    }
+    if (encoding == ImageEncoding::Raw)
+    {
+        addFrame(fileIndex, cv::imdecode(pngBytes, cv::IMREAD_COLOR), lidarRecords, nRecords);
+        return;
+    }
+
+    SequenceFrameEntry entry = {};
+    entry.fileIndex = fileIndex;
+    entry.encoding = (int32_t)ImageEncoding::PNG;
+    entry.rows = (int32_t)readBigEndian32(&pngBytes[20]);
+    entry.cols = (int32_t)readBigEndian32(&pngBytes[16]);
+    entry.type = CV_8UC3; // decoded like cv::imread does by default
+    entry.imageSize = pngBytes.size();
+    writeFrame(entry, pngBytes.data(), lidarRecords, nRecords);
+}
+
+void SequenceWriter::setCalibration(const cv::Mat &P_rect_00, const cv::Mat &R_rect_00, const cv::Mat &RT)
+{
+    if (P_rect_00.size() != cv::Size(4, 3) || R_rect_00.size() != cv::Size(4, 4) || RT.size() != cv::Size(4, 4))
+    {
+        throw invalid_argument("SequenceWriter: calibration must consist of a 3x4 and two 4x4 matrices");
+    }
+    calibration.clear();
+    for (const cv::Mat *m : {&P_rect_00, &R_rect_00, &RT})
+    {
+        cv::Mat m64;
+        m->convertTo(m64, CV_64F);
+        for (int r = 0; r < m64.rows; ++r)
+        {
+            calibration.insert(calibration.end(), m64.ptr<double>(r), m64.ptr<double>(r) + m64.cols);
+        }
+    }
+}
+
+void SequenceWriter::close()
+{
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    unordered_set<int> fileIndices;
+    for (auto &entry : entries)
+    {
+        if (!fileIndices.insert(entry.fileIndex).second)
+        {
+            file.close();
+            throw runtime_error("SequenceWriter: file index " + to_string(entry.fileIndex) + " occurs more than once");
+        }
+    }
+
+    SequenceTrailer trailer = {};
+    trailer.calibrationOffset = calibration.empty() ? 0 : position;
+    writeAligned(calibration.data(), calibration.size() * sizeof(double));
+    trailer.indexOffset = position;
+    writeAligned(entries.data(), entries.size() * sizeof(SequenceFrameEntry));
+    trailer.nFrames = (uint32_t)entries.size();
+    trailer.version = sequenceVersion;
+    memcpy(trailer.magic, sequenceMagic, 4);
+    writeAligned(&trailer, sizeof(trailer));
+
+    bool bFailed = !file;
+    file.close();
+    if (bFailed || !file)
+    {
+        throw runtime_error("SequenceWriter: writing the index failed");
+    }
+}
+
+SequenceReader::SequenceReader() : entries(nullptr), calib(nullptr), nFrames(0), minFileIndex(0) {}
+
+SequenceReader::SequenceReader(const string &filename) : SequenceReader()
+{
+    open(filename);
+}
+
+bool SequenceReader::open(const string &filename)
+{
+    entries = nullptr;
+    calib = nullptr;
+    nFrames = 0;
+    entryByFileIndex.clear();
+    if (!file.open(filename))
+    {
+        cout << "Sequence container " << filename << " could not be opened" << endl;
+        return false;
+    }
+
+    // every offset is checked against the file size, so that reads never leave the mapping
+    const char *data = file.data();
+    uint64_t size = file.size();
+    SequenceTrailer trailer;
+    bool bValid = size >= 8 + sizeof(trailer) && memcmp(data, sequenceMagic, 4) == 0;
+    if (bValid)
+    {
+        memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+        uint64_t indexEnd = size - sizeof(trailer);
+        bValid = memcmp(trailer.magic, sequenceMagic, 4) == 0 && trailer.version == sequenceVersion &&
+                 trailer.indexOffset % 8 == 0 && trailer.indexOffset <= indexEnd &&
+                 trailer.nFrames <= (indexEnd - trailer.indexOffset) / sizeof(SequenceFrameEntry) &&
+                 (trailer.calibrationOffset == 0 || (trailer.calibrationOffset % 8 == 0 &&
+                  trailer.calibrationOffset + calibrationSize * sizeof(double) <= trailer.indexOffset));
+    }
+    if (bValid)
+    {
+        entries = (const SequenceFrameEntry *)(data + trailer.indexOffset);
+        for (size_t i = 0; i < trailer.nFrames && bValid; ++i)
+        {
+            const SequenceFrameEntry &entry = entries[i];
+            bool bRaw = entry.encoding == (int32_t)ImageEncoding::Raw;
+            bValid = (bRaw || entry.encoding == (int32_t)ImageEncoding::PNG) && entry.rows > 0 && entry.cols > 0 &&
+                     entry.imageOffset <= trailer.indexOffset && entry.imageSize <= trailer.indexOffset - entry.imageOffset &&
+                     entry.lidarOffset % 8 == 0 && entry.lidarOffset <= trailer.indexOffset &&
+                     entry.lidarCount <= (trailer.indexOffset - entry.lidarOffset) / sizeof(LidarRecord) &&
+                     (!bRaw || (entry.type >= 0 && entry.type < CV_DEPTH_MAX * CV_CN_MAX &&
+                                entry.imageSize == (uint64_t)entry.rows * entry.cols * CV_ELEM_SIZE(entry.type)));
+        }
+    }
+    if (!bValid)
+    {
+        cout << "Sequence container " << filename << " is truncated or corrupt" << endl;
+        file.close();
+        entries = nullptr;
+        return false;
+    }
+    nFrames = trailer.nFrames;
+    calib = trailer.calibrationOffset ? (const double *)(data + trailer.calibrationOffset) : nullptr;
+
+    // direct lookup table over the range of file indices; the range is bounded so that a corrupt index cannot
+    // allocate arbitrary amounts of memory
+    if (nFrames > 0)
+    {
+        int maxFileIndex = entries[0].fileIndex;
+        minFileIndex = entries[0].fileIndex;
+        for (size_t i = 1; i < nFrames; ++i)
+        {
+            minFileIndex = min(minFileIndex, (int)entries[i].fileIndex);
+            maxFileIndex = max(maxFileIndex, (int)entries[i].fileIndex);
+        }
+        int64_t range = (int64_t)maxFileIndex - minFileIndex + 1;
+        if (range > 64 * (int64_t)nFrames + 1024)
+        {
+            cout << "Sequence container " << filename << " has too sparse file indices" << endl;
+            file.close();
+            entries = nullptr;
+            nFrames = 0;
+            return false;
+        }
+        entryByFileIndex.assign(range, -1);
+        for (size_t i = 0; i < nFrames; ++i)
+        {
+            entryByFileIndex[entries[i].fileIndex - minFileIndex] = (int)i;
+        }
+    }
+    return true;
+}
+
+const SequenceFrameEntry *SequenceReader::entryOf(int fileIndex) const
+{
+    int64_t slot = (int64_t)fileIndex - minFileIndex;
+    if (slot < 0 || slot >= (int64_t)entryByFileIndex.size() || entryByFileIndex[slot] < 0)
+    {
+        return nullptr;
+    }
+    return &entries[entryByFileIndex[slot]];
+}
+
+void SequenceReader::read(int fileIndex, SensorFrame &frame) const
+{
+    const SequenceFrameEntry *entry = entryOf(fileIndex);
+    if (!entry)
+    {
+        throw out_of_range("SequenceReader: no frame with file index " + to_string(fileIndex));
+    }
+
+    // the image is decoded into the buffer of the frame, raw pixels are copied out of the mapping
+    const uchar *imgBytes = (const uchar *)file.data() + entry->imageOffset;
+    releaseIfShared(frame.cameraImg);
+    if (entry->encoding == (int32_t)ImageEncoding::Raw)
+    {
+        frame.cameraImg.create(entry->rows, entry->cols, entry->type);
+        memcpy(frame.cameraImg.data, imgBytes, entry->imageSize);
+    }
+    else
+    {
+        cv::Mat encodedImg(1, (int)entry->imageSize, CV_8U, (void *)imgBytes);
+        int flags = entry->type == CV_8UC3 ? cv::IMREAD_COLOR : cv::IMREAD_UNCHANGED;
+        cv::imdecode(encodedImg, flags, &frame.cameraImg);
+        if (frame.cameraImg.rows != entry->rows || frame.cameraImg.cols != entry->cols)
+        {
+            throw runtime_error("SequenceReader: image of frame " + to_string(fileIndex) + " cannot be decoded");
+        }
+    }
+    frame.index = fileIndex;
+
+    // Lidar records are 8-byte aligned in the file and converted to the structure of arrays in a single pass
+    const LidarRecord *records = (const LidarRecord *)(file.data() + entry->lidarOffset);
+    LidarCloud &lidarPoints = frame.lidarPoints;
+    lidarPoints.resize(entry->lidarCount);
+    lidarPoints.boxIDs.clear();
+    for (size_t i = 0; i < entry->lidarCount; ++i)
+    {
+        lidarPoints.x[i] = records[i].x;
+        lidarPoints.y[i] = records[i].y;
+        lidarPoints.z[i] = records[i].z;
+        lidarPoints.r[i] = records[i].r;
+    }
+}
+
+PrefetchReader::ReadFunction SequenceReader::readFunction() const
+{
+    return [this](int index, SensorFrame &frame) { read(index, frame); };
+}
+
+bool SequenceReader::calibration(cv::Mat &P_rect_00, cv::Mat &R_rect_00, cv::Mat &RT) const
+{
+    if (!calib)
+    {
+        return false;
+    }
+    const double *values = calib;
+    for (cv::Mat *m : {&P_rect_00, &R_rect_00, &RT})
+    {
+        m->create(m == &P_rect_00 ? 3 : 4, 4, CV_64F);
+        for (int r = 0; r < m->rows; ++r, values += 4)
+        {
+            memcpy(m->ptr<double>(r), values, 4 * sizeof(double));
+        }
+    }
+    return true;
+}
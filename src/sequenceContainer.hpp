@@ -0,0 +1,116 @@
+
+#ifndef sequenceContainer_hpp
+#define sequenceContainer_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+#include "mappedFile.hpp"
+#include "prefetchReader.hpp"
+
+// Single file holding a recorded sequence : per frame the camera image and the Lidar scan, followed by the calibration
+// and an index with the offsets of every frame, so that any frame is found without scanning the file.
+//
+//   header   "KSEQ" + format version
+//   frames   image bytes and Lidar records (x, y, z, r as float) of every frame, each section 8-byte aligned
+//   calib    P_rect_00 (3x4), R_rect_00 (4x4), RT (4x4) as doubles, row-major
+//   index    one SequenceFrameEntry per frame in the order of writing
+//   trailer  SequenceTrailer at the very end of the file
+//
+// Numbers are stored in the byte order of the writing machine (little-endian on x86 and ARM).
+enum class ImageEncoding { Raw, PNG }; // Raw : pixels as stored in the cv::Mat, PNG : lossless compression
+
+struct SequenceFrameEntry
+{
+    int32_t fileIndex;
+    int32_t encoding; // ImageEncoding
+    int32_t rows, cols, type; // image size and OpenCV type, needed to interpret raw pixels
+    int32_t reserved;
+    uint64_t imageOffset, imageSize; // in bytes from the start of the file
+    uint64_t lidarOffset, lidarCount; // lidarCount LidarRecords
+};
+
+struct SequenceTrailer
+{
+    uint64_t indexOffset;
+    uint64_t calibrationOffset; // 0 if the container holds no calibration
+    uint32_t nFrames;
+    uint32_t version;
+    char magic[8];
+};
+
+// writes a container frame by frame; the index is written by close, a container which has not been closed is invalid
+class SequenceWriter
+{
+public:
+    // throws std::runtime_error if the file cannot be created
+    explicit SequenceWriter(const std::string &filename, ImageEncoding encoding = ImageEncoding::PNG);
+    ~SequenceWriter(); // closes the container
+
+    SequenceWriter(const SequenceWriter &) = delete;
+    SequenceWriter &operator=(const SequenceWriter &) = delete;
+
+    // fileIndex is the index by which the frame is read back, each one may occur only once
+    void addFrame(int fileIndex, const cv::Mat &img, const LidarRecord *lidarRecords, size_t nRecords);
+    // stores an image which is already PNG-encoded (e.g. the contents of a .png file) without decoding it; the image
+    // size is taken from the PNG header
+    void addEncodedFrame(int fileIndex, const std::vector<uchar> &pngBytes, const LidarRecord *lidarRecords, size_t nRecords);
+
+    void setCalibration(const cv::Mat &P_rect_00, const cv::Mat &R_rect_00, const cv::Mat &RT);
+
+    void close(); // writes calibration, index and trailer
+
+    size_t size() const { return entries.size(); }
+    uint64_t bytesWritten() const { return position; }
+
+private:
+    void writeFrame(SequenceFrameEntry entry, const uchar *imgBytes, const LidarRecord *lidarRecords, size_t nRecords);
+    void writeAligned(const void *data, size_t nBytes);
+
+    std::ofstream file;
+    ImageEncoding encoding;
+    uint64_t position; // no. of bytes written so far
+    std::vector<SequenceFrameEntry> entries;
+    std::vector<double> calibration; // empty until setCalibration
+    std::vector<uchar> encoded; // scratch of the PNG encoder
+};
+
+// read-only access to a memory-mapped container; read may be called on several threads at the same time
+class SequenceReader
+{
+public:
+    SequenceReader();
+    explicit SequenceReader(const std::string &filename);
+
+    // returns false if the file is missing, truncated or not a container
+    bool open(const std::string &filename);
+    bool isOpen() const { return file.isOpen(); }
+
+    size_t size() const { return nFrames; }
+    const SequenceFrameEntry &entry(size_t position) const { return entries[position]; } // in the order of writing
+    bool contains(int fileIndex) const { return entryOf(fileIndex) != nullptr; }
+
+    // decodes the image and copies the Lidar scan of the frame with the given file index, found in O(1); throws
+    // std::out_of_range if the container has no such frame
+    void read(int fileIndex, SensorFrame &frame) const;
+    PrefetchReader::ReadFunction readFunction() const; // read as a function, the reader must outlive it
+
+    // returns false if the container holds no calibration
+    bool calibration(cv::Mat &P_rect_00, cv::Mat &R_rect_00, cv::Mat &RT) const;
+
+private:
+    const SequenceFrameEntry *entryOf(int fileIndex) const;
+
+    MappedFile file;
+    const SequenceFrameEntry *entries; // index in the mapped file
+    const double *calib;
+    size_t nFrames;
+    int minFileIndex;
+    std::vector<int> entryByFileIndex; // entry of fileIndex at fileIndex - minFileIndex, -1 for none
+};
+
+#endif /* sequenceContainer_hpp */
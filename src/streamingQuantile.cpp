@@ -0,0 +1,118 @@
+
+#include <cmath>
+#include <algorithm>
+
+#include "streamingQuantile.hpp"
+
+using namespace std;
+
+StreamingQuantile::StreamingQuantile(double p) : p(p)
+{
+    clear();
+}
+
+void StreamingQuantile::clear()
+{
+    nValues = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+        q[i] = 0.0;
+        n[i] = i + 1;
+    }
+    nDesired[0] = 1.0;
+    nDesired[1] = 1.0 + 2.0 * p;
+    nDesired[2] = 1.0 + 4.0 * p;
+    nDesired[3] = 3.0 + 2.0 * p;
+    nDesired[4] = 5.0;
+    dn[0] = 0.0;
+    dn[1] = p / 2.0;
+    dn[2] = p;
+    dn[3] = (1.0 + p) / 2.0;
+    dn[4] = 1.0;
+}
+
+void StreamingQuantile::add(double x)
+{
+    // the first 5 values initialize the markers
+    if (nValues < 5)
+    {
+        q[nValues++] = x;
+        if (nValues == 5)
+        {
+            sort(q, q + 5);
+        }
+        return;
+    }
+    ++nValues;
+
+    // find the cell containing x and widen the outer markers if necessary
+    int k;
+    if (x < q[0])
+    {
+        q[0] = x;
+        k = 0;
+    }
+    else if (x >= q[4])
+    {
+        q[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (x >= q[k + 1])
+        {
+            ++k;
+        }
+    }
+
+    for (int i = k + 1; i < 5; ++i)
+    {
+        n[i] += 1.0;
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        nDesired[i] += dn[i];
+    }
+
+    // move the inner markers towards their desired positions, using a piecewise-parabolic prediction of the heights
+    for (int i = 1; i <= 3; ++i)
+    {
+        double d = nDesired[i] - n[i];
+        if ((d >= 1.0 && n[i + 1] - n[i] > 1.0) || (d <= -1.0 && n[i - 1] - n[i] < -1.0))
+        {
+            int s = d > 0.0 ? 1 : -1;
+            double qParabolic = q[i] + s / (n[i + 1] - n[i - 1]) *
+                                ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                                 (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+            if (q[i - 1] < qParabolic && qParabolic < q[i + 1])
+            {
+                q[i] = qParabolic;
+            }
+            else
+            {
+                q[i] = q[i] + s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+            }
+            n[i] += s;
+        }
+    }
+}
+
+double StreamingQuantile::value() const
+{
+    if (nValues == 0)
+    {
+        return NAN;
+    }
+    if (nValues < 5)
+    {
+        // exact quantile of the few values seen so far (median of an even count is the mean of the middle values)
+        double sorted[5];
+        copy(q, q + nValues, sorted);
+        sort(sorted, sorted + nValues);
+        double pos = p * (nValues - 1);
+        size_t lo = (size_t)floor(pos), hi = (size_t)ceil(pos);
+        return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+    }
+    return q[2];
+}
@@ -0,0 +1,27 @@
+
+#ifndef streamingQuantile_hpp
+#define streamingQuantile_hpp
+
+#include <cstddef>
+
+// running estimate of a quantile in constant memory (P-square algorithm by Jain and Chlamtac), exact for up to 5 values
+class StreamingQuantile
+{
+public:
+    explicit StreamingQuantile(double p = 0.5);
+
+    void add(double x);
+    double value() const; // NaN if no value has been added
+    size_t count() const { return nValues; }
+    void clear();
+
+private:
+    double p;
+    size_t nValues;
+    double q[5]; // marker heights
+    double n[5]; // marker positions
+    double nDesired[5]; // desired marker positions
+    double dn[5]; // increments of the desired positions
+};
+
+#endif /* streamingQuantile_hpp */
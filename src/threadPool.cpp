@@ -0,0 +1,100 @@
+
+#include <algorithm>
+
+#include "threadPool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t nThreads)
+    : task(nullptr), nTasks(0), nextTask(0), nActiveWorkers(0), generation(0), bStopping(false)
+{
+    // hardware_concurrency() may return 0 if the no. of cores is unknown
+    for (size_t i = 1; i < max((size_t)1, nThreads); ++i)
+    {
+        workers.push_back(thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        bStopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, const function<void(size_t)> &loopTask)
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        task = &loopTask;
+        nTasks = n;
+        nextTask = 0;
+        nActiveWorkers = workers.size();
+        error = nullptr;
+        ++generation;
+    }
+    wake.notify_all();
+
+    runTasks();
+
+    unique_lock<mutex> lock(mtx);
+    done.wait(lock, [this] { return nActiveWorkers == 0; });
+    task = nullptr;
+    if (error)
+    {
+        exception_ptr loopError = error;
+        error = nullptr;
+        rethrow_exception(loopError);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    size_t seenGeneration = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(mtx);
+            wake.wait(lock, [&] { return bStopping || generation != seenGeneration; });
+            if (bStopping)
+            {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runTasks();
+
+        lock_guard<mutex> lock(mtx);
+        if (--nActiveWorkers == 0)
+        {
+            done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runTasks()
+{
+    // indices are handed out one at a time, so that threads which finish early take over the remaining work
+    for (size_t i = nextTask++; i < nTasks; i = nextTask++)
+    {
+        try
+        {
+            (*task)(i);
+        }
+        catch (...)
+        {
+            lock_guard<mutex> lock(mtx);
+            if (!error)
+            {
+                error = current_exception();
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+
+#ifndef threadPool_hpp
+#define threadPool_hpp
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+// fixed set of worker threads which process the indices of a parallel loop; the calling thread takes part in the loop,
+// so a pool of size 1 has no worker threads and runs everything inline. Only one loop may run at a time.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t nThreads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // calls task(i) for i = 0 ... n-1 and returns when all calls have finished; the first exception thrown by a task
+    // is rethrown on the calling thread once the loop has ended
+    void parallelFor(size_t n, const std::function<void(size_t)> &task);
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable wake; // a new loop has started or the pool is shut down
+    std::condition_variable done; // all workers have left the current loop
+
+    const std::function<void(size_t)> *task;
+    size_t nTasks;
+    std::atomic<size_t> nextTask;
+    size_t nActiveWorkers;
+    size_t generation; // no. of loops started so far
+    bool bStopping;
+    std::exception_ptr error;
+};
+
+#endif /* threadPool_hpp */
@@ -0,0 +1,169 @@
+
+#include <algorithm>
+
+#include "trackManager.hpp"
+#include "hungarian.hpp"
+
+using namespace std;
+
+static double intersectionOverUnion(const cv::Rect &a, const cv::Rect &b)
+{
+    double intersection = (a & b).area();
+    double unionArea = a.area() + b.area() - intersection;
+    return unionArea > 0.0 ? intersection / unionArea : 0.0;
+}
+
+TrackManager::TrackManager(int maxMisses, double minIoU) : maxMisses(maxMisses), minIoU(minIoU), nextTrackID(0) {}
+
+void TrackManager::update(const std::map<int, int> &bbMatches, const DataFrame *prevFrame, DataFrame &currFrame)
+{
+    ended.clear();
+    vector<BoundingBox> &currBoxes = currFrame.boundingBoxes;
+    for (auto it = currBoxes.begin(); it != currBoxes.end(); ++it)
+    {
+        it->trackID = -1;
+    }
+
+    // the current frame becomes the previous one
+    for (auto it = trackMap.begin(); it != trackMap.end(); ++it)
+    {
+        it->second.prevBoxIdx = it->second.currBoxIdx;
+        it->second.currBoxIdx = -1;
+    }
+
+    // 1. keypoint based box matches continue the track of the previous box, as long as the boxes overlap at all
+    if (prevFrame)
+    {
+        map<int, int> currIdxByID;
+        for (size_t i = 0; i < currBoxes.size(); ++i)
+        {
+            currIdxByID[currBoxes[i].boxID] = i;
+        }
+        for (size_t i = 0; i < prevFrame->boundingBoxes.size(); ++i)
+        {
+            const BoundingBox &prevBox = prevFrame->boundingBoxes[i];
+            auto match = bbMatches.find(prevBox.boxID);
+            auto track = trackMap.find(prevBox.trackID);
+            if (match == bbMatches.end() || track == trackMap.end() || track->second.currBoxIdx >= 0)
+            {
+                continue;
+            }
+            auto curr = currIdxByID.find(match->second);
+            if (curr == currIdxByID.end() || currBoxes[curr->second].trackID >= 0)
+            {
+                continue; // current box already continues another track
+            }
+            if (intersectionOverUnion(prevBox.roi, currBoxes[curr->second].roi) > 0.0)
+            {
+                track->second.currBoxIdx = curr->second;
+                currBoxes[curr->second].trackID = track->first;
+            }
+        }
+    }
+
+    // 2. remaining boxes and tracks are associated by the overlap with the last ROI of each track
+    vector<int> freeBoxes, freeTracks;
+    for (size_t i = 0; i < currBoxes.size(); ++i)
+    {
+        if (currBoxes[i].trackID < 0)
+        {
+            freeBoxes.push_back(i);
+        }
+    }
+    for (auto it = trackMap.begin(); it != trackMap.end(); ++it)
+    {
+        if (it->second.currBoxIdx < 0)
+        {
+            freeTracks.push_back(it->first);
+        }
+    }
+    sort(freeTracks.begin(), freeTracks.end()); // deterministic order, independent of the hash map
+    if (!freeBoxes.empty() && !freeTracks.empty())
+    {
+        vector<double> cost(freeTracks.size() * freeBoxes.size());
+        for (size_t t = 0; t < freeTracks.size(); ++t)
+        {
+            for (size_t b = 0; b < freeBoxes.size(); ++b)
+            {
+                cost[t * freeBoxes.size() + b] = 1.0 - intersectionOverUnion(trackMap[freeTracks[t]].lastRoi, currBoxes[freeBoxes[b]].roi);
+            }
+        }
+        vector<int> trackToBox;
+        solveAssignment(cost, freeTracks.size(), freeBoxes.size(), trackToBox);
+        for (size_t t = 0; t < freeTracks.size(); ++t)
+        {
+            if (trackToBox[t] >= 0 && 1.0 - cost[t * freeBoxes.size() + trackToBox[t]] >= minIoU)
+            {
+                int boxIdx = freeBoxes[trackToBox[t]];
+                trackMap[freeTracks[t]].currBoxIdx = boxIdx;
+                currBoxes[boxIdx].trackID = freeTracks[t];
+            }
+        }
+    }
+
+    // 3. boxes without a track start a new one
+    for (size_t i = 0; i < currBoxes.size(); ++i)
+    {
+        if (currBoxes[i].trackID < 0)
+        {
+            Track track;
+            track.trackID = nextTrackID++;
+            track.age = -1; // incremented below
+            track.misses = 0;
+            track.currBoxIdx = i;
+            track.prevBoxIdx = -1;
+            trackMap[track.trackID] = track;
+            currBoxes[i].trackID = track.trackID;
+        }
+    }
+
+    // 4. bookkeeping, tracks which have been missed too often end
+    for (auto it = trackMap.begin(); it != trackMap.end();)
+    {
+        Track &track = it->second;
+        ++track.age;
+        if (track.currBoxIdx >= 0)
+        {
+            const cv::Rect &roi = currBoxes[track.currBoxIdx].roi;
+            if (track.age > 0) // averaged over the frames in which the track was missed
+            {
+                cv::Point2f centre(roi.x + 0.5f * roi.width, roi.y + 0.5f * roi.height);
+                cv::Point2f lastCentre(track.lastRoi.x + 0.5f * track.lastRoi.width, track.lastRoi.y + 0.5f * track.lastRoi.height);
+                track.motion = (centre - lastCentre) * (1.0f / (track.misses + 1));
+            }
+            track.misses = 0;
+            track.lastRoi = roi;
+        }
+        else if (++track.misses > maxMisses)
+        {
+            ended.push_back(it->first);
+            it = trackMap.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+const Track *TrackManager::find(int trackID) const
+{
+    auto it = trackMap.find(trackID);
+    return it == trackMap.end() ? nullptr : &it->second;
+}
+
+void TrackManager::predictKeypointShift(const DataFrame &frame, vector<cv::Point2f> &shift) const
+{
+    shift.assign(frame.keypoints.size(), cv::Point2f(0.0f, 0.0f));
+    for (size_t i = 0; i < frame.keypoints.size(); ++i)
+    {
+        int boxIdx = frame.roiIndex.queryUnique(frame.keypoints[i].pt);
+        if (boxIdx < 0)
+        {
+            continue;
+        }
+        const Track *track = find(frame.boundingBoxes[boxIdx].trackID);
+        if (track != nullptr && track->currBoxIdx == boxIdx)
+        {
+            shift[i] = track->motion;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+
+#ifndef trackManager_hpp
+#define trackManager_hpp
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+
+#include "dataStructures.h"
+
+struct Track { // object followed over successive frames
+    int trackID;
+    int age; // no. of frames since the track was started
+    int misses; // no. of consecutive frames without an associated box
+    int currBoxIdx; // index into the boundingBoxes of the current frame, -1 if missed in this frame
+    int prevBoxIdx; // index into the boundingBoxes of the previous frame, -1 if missed or not yet started there
+    cv::Rect lastRoi; // ROI of the last associated box
+    cv::Point2f motion; // [pixels/frame] shift of the ROI centre between the last two associated boxes
+};
+
+// keeps tracks of the objects across frames and sets BoundingBox::trackID; boxes are associated with tracks through the
+// keypoint based box matches first and by the overlap (IoU) with the last ROI of a track second
+class TrackManager
+{
+public:
+    // tracks are dropped after more than maxMisses frames without a box; IoU association requires at least minIoU
+    explicit TrackManager(int maxMisses = 2, double minIoU = 0.3);
+
+    // associates the boxes of currFrame with the tracks, prevFrame must be the frame of the previous call (nullptr for
+    // the first frame); bbMatches maps boxIDs of prevFrame to boxIDs of currFrame
+    void update(const std::map<int, int> &bbMatches, const DataFrame *prevFrame, DataFrame &currFrame);
+
+    const Track *find(int trackID) const; // O(1), nullptr if the track does not exist (anymore)
+
+    // expected shift of each keypoint of frame (the frame of the last update) until the next frame : the motion of the
+    // track of the box which uniquely contains the keypoint according to frame.roiIndex, zero for all other keypoints
+    void predictKeypointShift(const DataFrame &frame, std::vector<cv::Point2f> &shift) const;
+    const std::unordered_map<int, Track> &tracks() const { return trackMap; }
+    const std::vector<int> &endedTracks() const { return ended; } // tracks dropped in the last update
+
+private:
+    int maxMisses;
+    double minIoU;
+    int nextTrackID;
+    std::unordered_map<int, Track> trackMap;
+    std::vector<int> ended;
+};
+
+#endif /* trackManager_hpp */
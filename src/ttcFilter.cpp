@@ -0,0 +1,137 @@
+
+#include <cmath>
+#include <limits>
+
+#include "ttcFilter.hpp"
+
+using namespace std;
+
+TTCFilter::TTCFilter(const TTCFilterParams &params)
+    : params(params), bInitialized(false), bHasTime(false), timestamp(0.0), d(0.0), v(0.0)
+{
+    P[0][0] = P[0][1] = P[1][0] = P[1][1] = 0.0;
+}
+
+void TTCFilter::predict(double t)
+{
+    double dt = bHasTime ? t - timestamp : 0.0;
+    timestamp = t;
+    bHasTime = true;
+    if (!bInitialized || dt <= 0.0)
+    {
+        return;
+    }
+
+    // x = F x with F = [1 dt; 0 1]
+    d += v * dt;
+
+    // P = F P F' + Q, Q from a white acceleration of variance q
+    double q = params.accelerationNoise * params.accelerationNoise;
+    double dt2 = dt * dt;
+    double p00 = P[0][0] + dt * (P[0][1] + P[1][0]) + dt2 * P[1][1] + q * dt2 * dt2 / 4.0;
+    double p01 = P[0][1] + dt * P[1][1] + q * dt2 * dt / 2.0;
+    double p11 = P[1][1] + q * dt2;
+    P[0][0] = p00;
+    P[0][1] = P[1][0] = p01;
+    P[1][1] = p11;
+}
+
+void TTCFilter::update(int component, double measurement, double variance)
+{
+    // scalar measurement of one state component, H = e_component
+    double innovation = measurement - (component == 0 ? d : v);
+    double s = P[component][component] + variance;
+    double k0 = P[0][component] / s, k1 = P[1][component] / s;
+    d += k0 * innovation;
+    v += k1 * innovation;
+
+    // P = (I - K H) P
+    double pc0 = P[component][0], pc1 = P[component][1];
+    P[0][0] -= k0 * pc0;
+    P[0][1] -= k0 * pc1;
+    P[1][0] -= k1 * pc0;
+    P[1][1] -= k1 * pc1;
+}
+
+void TTCFilter::updateLidarDistance(double distance)
+{
+    double r = params.lidarDistanceNoise * params.lidarDistanceNoise;
+    if (!bInitialized)
+    {
+        d = distance;
+        v = 0.0;
+        P[0][0] = r;
+        P[0][1] = P[1][0] = 0.0;
+        P[1][1] = params.initialSpeedNoise * params.initialSpeedNoise;
+        bInitialized = true;
+        return;
+    }
+    update(0, distance, r);
+}
+
+void TTCFilter::updateCameraTTC(double ttc)
+{
+    if (!bInitialized || ttc == 0.0)
+    {
+        return;
+    }
+    update(1, -d / ttc, params.cameraSpeedNoise * params.cameraSpeedNoise);
+}
+
+double TTCFilter::ttc() const
+{
+    if (!bInitialized)
+    {
+        return NAN;
+    }
+    return v < 0.0 ? -d / v : numeric_limits<double>::infinity();
+}
+
+double TTCFilterBank::update(int trackID, double timestamp, double lidarDistance, double cameraTTC)
+{
+    auto it = filters.find(trackID);
+    if (it == filters.end())
+    {
+        Track track = {TTCFilter(params), timestamp};
+        it = filters.insert(make_pair(trackID, track)).first;
+    }
+
+    Track &track = it->second;
+    track.filter.predict(timestamp);
+    track.lastUpdate = timestamp;
+    if (std::isfinite(lidarDistance))
+    {
+        track.filter.updateLidarDistance(lidarDistance);
+    }
+    if (std::isfinite(cameraTTC))
+    {
+        track.filter.updateCameraTTC(cameraTTC);
+    }
+    return track.filter.ttc();
+}
+
+void TTCFilterBank::removeStaleTracks(double timestamp)
+{
+    for (auto it = filters.begin(); it != filters.end();)
+    {
+        if (timestamp - it->second.lastUpdate > maxTrackAge)
+        {
+            it = filters.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void TTCFilterBank::remove(int trackID)
+{
+    filters.erase(trackID);
+}
+
+const TTCFilter *TTCFilterBank::find(int trackID) const
+{
+    auto it = filters.find(trackID);
+    return it == filters.end() ? nullptr : &it->second.filter;
+}
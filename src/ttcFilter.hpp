@@ -0,0 +1,74 @@
+
+#ifndef ttcFilter_hpp
+#define ttcFilter_hpp
+
+#include <cstddef>
+#include <map>
+
+// noise settings of the constant-velocity TTC filter
+struct TTCFilterParams {
+    double accelerationNoise; // std. deviation of the unmodelled relative acceleration in [m/s^2]
+    double lidarDistanceNoise; // std. deviation of a Lidar distance measurement in [m]
+    double cameraSpeedNoise; // std. deviation of the closing speed derived from a camera TTC in [m/s]
+    double initialSpeedNoise; // std. deviation of the closing speed when a track starts in [m/s]
+
+    TTCFilterParams() : accelerationNoise(2.0), lidarDistanceNoise(0.05), cameraSpeedNoise(1.0), initialSpeedNoise(5.0) {}
+};
+
+// constant-velocity Kalman filter over the distance to an object and its range rate (negative when closing in);
+// every step is O(1), so the TTC of a track is refined incrementally without reprocessing earlier frames
+class TTCFilter
+{
+public:
+    explicit TTCFilter(const TTCFilterParams &params = TTCFilterParams());
+
+    // advances the state to the given time in [s]; the first call only sets the time
+    void predict(double timestamp);
+    // Lidar measures the distance directly, initializes the filter on the first call
+    void updateLidarDistance(double distance);
+    // the camera measures the TTC = -distance / rangeRate, which is turned into a range rate with the current distance;
+    // ignored as long as no Lidar distance has initialized the filter
+    void updateCameraTTC(double ttc);
+
+    bool isInitialized() const { return bInitialized; }
+    double distance() const { return d; }
+    double rangeRate() const { return v; }
+    double ttc() const; // infinite if the object is not approaching, NaN if not initialized
+
+private:
+    void update(int component, double measurement, double variance);
+
+    TTCFilterParams params;
+    bool bInitialized;
+    bool bHasTime;
+    double timestamp;
+    double d, v; // state
+    double P[2][2]; // state covariance
+};
+
+// one TTCFilter per track, keyed by BoundingBox::trackID
+class TTCFilterBank
+{
+public:
+    explicit TTCFilterBank(const TTCFilterParams &params = TTCFilterParams(), double maxTrackAge = 1.0)
+        : params(params), maxTrackAge(maxTrackAge) {}
+
+    // predicts the track's filter to timestamp and fuses the measurements which are finite (pass NaN to skip one);
+    // returns the filtered TTC of the track
+    double update(int trackID, double timestamp, double lidarDistance, double cameraTTC);
+    // drops the filters of tracks which have not been updated for more than maxTrackAge seconds
+    void removeStaleTracks(double timestamp);
+    void remove(int trackID);
+
+    const TTCFilter *find(int trackID) const;
+    size_t size() const { return filters.size(); }
+
+private:
+    struct Track { TTCFilter filter; double lastUpdate; };
+
+    TTCFilterParams params;
+    double maxTrackAge; // [s]
+    std::map<int, Track> filters;
+};
+
+#endif /* ttcFilter_hpp */
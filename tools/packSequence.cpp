@@ -0,0 +1,98 @@
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <limits>
+#include <vector>
+#include <stdexcept>
+
+#include "sequenceContainer.hpp"
+#include "mappedFile.hpp"
+#include "lidarData.hpp"
+
+using namespace std;
+
+static void printUsage(const char *program)
+{
+    cout << "Usage: " << program << " <dataPath> <output> [startIndex endIndex] [--raw]" << endl;
+    cout << "Packs the KITTI camera images and Lidar scans below dataPath together with the calibration into a single" << endl;
+    cout << "sequence container. The PNG files are stored as they are, --raw stores decoded pixels instead." << endl;
+}
+
+int main(int argc, const char *argv[])
+{
+    vector<string> args;
+    bool bRaw = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (string(argv[i]) == "--raw")
+        {
+            bRaw = true;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() != 2 && args.size() != 4)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // same layout as in the tracking application
+    string dataPath = args[0];
+    if (!dataPath.empty() && dataPath[dataPath.size() - 1] != '/')
+    {
+        dataPath += "/";
+    }
+    string imgPrefix = dataPath + "images/KITTI/2011_09_26/image_02/data/000000";
+    string lidarPrefix = dataPath + "images/KITTI/2011_09_26/velodyne_points/data/000000";
+    int imgFillWidth = 4;
+    int startIndex = args.size() == 4 ? stoi(args[2]) : 0;
+    int endIndex = args.size() == 4 ? stoi(args[3]) : numeric_limits<int>::max(); // up to the first missing image
+
+    try
+    {
+        double t = (double)cv::getTickCount();
+        SequenceWriter writer(args[1], bRaw ? ImageEncoding::Raw : ImageEncoding::PNG);
+        cv::Mat P_rect_00, R_rect_00, RT;
+        loadKittiCalibration(P_rect_00, R_rect_00, RT);
+        writer.setCalibration(P_rect_00, R_rect_00, RT);
+
+        vector<uchar> pngBytes;
+        for (int index = startIndex; index <= endIndex; ++index)
+        {
+            ostringstream imgNumber;
+            imgNumber << setfill('0') << setw(imgFillWidth) << index;
+            MappedFile imgFile(imgPrefix + imgNumber.str() + ".png");
+            if (!imgFile.isOpen())
+            {
+                if (args.size() == 4)
+                {
+                    throw runtime_error("cannot read " + imgPrefix + imgNumber.str() + ".png");
+                }
+                break;
+            }
+            LidarScan scan;
+            if (!scan.open(lidarPrefix + imgNumber.str() + ".bin"))
+            {
+                throw runtime_error("cannot read " + lidarPrefix + imgNumber.str() + ".bin");
+            }
+            pngBytes.assign(imgFile.data(), imgFile.data() + imgFile.size());
+            writer.addEncodedFrame(index, pngBytes, scan.begin(), scan.size());
+        }
+        writer.close();
+
+        t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+        cout << "packed " << writer.size() << " frames into " << args[1] << " (" << fixed << setprecision(1)
+             << writer.bytesWritten() / 1.0e6 << " MB) in " << setprecision(2) << t << " s" << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}